@@ -0,0 +1,321 @@
+//! Benchmarks for the analysis hot paths.
+//!
+//! Run with: cargo bench --bench hot_paths
+//!
+//! With `--features c-reference` the dot and line analyses are also timed
+//! through the original C implementation, as a baseline.
+
+use std::hint::black_box;
+
+use criterion::{Criterion, Throughput, criterion_group, criterion_main};
+use imgref::ImgVec;
+use resamplescope::analyze::{self, FilterCurve};
+use resamplescope::{KnownFilter, graph, pattern, score};
+
+struct Fixture {
+    dot: ImgVec<u8>,
+    line: ImgVec<u8>,
+    downscale: FilterCurve,
+    upscale: FilterCurve,
+}
+
+fn fixture() -> Fixture {
+    let (dot_w, dot_h) = analyze::dot_target();
+    let (line_w, line_h) = analyze::line_target();
+    let dot =
+        resamplescope::perfect_resize(pattern::dot_pattern(), dot_w, dot_h, KnownFilter::Lanczos3);
+    let line = resamplescope::perfect_resize(
+        pattern::line_pattern(),
+        line_w,
+        line_h,
+        KnownFilter::Lanczos3,
+    );
+    let downscale = analyze::analyze_dot(&dot.as_ref(), false);
+    let upscale = analyze::analyze_line(&line.as_ref(), false);
+    Fixture {
+        dot,
+        line,
+        downscale,
+        upscale,
+    }
+}
+
+fn pixels(img: &ImgVec<u8>) -> u64 {
+    (img.width() * img.height()) as u64
+}
+
+fn bench_analysis(c: &mut Criterion) {
+    let f = fixture();
+
+    let mut group = c.benchmark_group("analyze_dot");
+    group.throughput(Throughput::Elements(pixels(&f.dot)));
+    for srgb in [false, true] {
+        let id = if srgb { "rust/srgb" } else { "rust/linear" };
+        group.bench_function(id, |b| {
+            b.iter(|| analyze::analyze_dot(black_box(&f.dot.as_ref()), srgb))
+        });
+    }
+    #[cfg(feature = "c-reference")]
+    for srgb in [false, true] {
+        let id = if srgb { "c/srgb" } else { "c/linear" };
+        group.bench_function(id, |b| {
+            b.iter(|| c_shim::analyze_dot(black_box(&f.dot), srgb))
+        });
+    }
+    group.finish();
+
+    let mut group = c.benchmark_group("analyze_line");
+    group.throughput(Throughput::Elements(pixels(&f.line)));
+    for srgb in [false, true] {
+        let id = if srgb { "rust/srgb" } else { "rust/linear" };
+        group.bench_function(id, |b| {
+            b.iter(|| analyze::analyze_line(black_box(&f.line.as_ref()), srgb))
+        });
+    }
+    #[cfg(feature = "c-reference")]
+    for srgb in [false, true] {
+        let id = if srgb { "c/srgb" } else { "c/linear" };
+        group.bench_function(id, |b| {
+            b.iter(|| c_shim::analyze_line(black_box(&f.line), srgb))
+        });
+    }
+    group.finish();
+
+    // The same dot image nine times, once per named filter in a comparison run.
+    const BATCH: usize = 9;
+    let batch: Vec<u8> = f.dot.buf().repeat(BATCH);
+    let mut group = c.benchmark_group("analyze_dot_batch");
+    group.throughput(Throughput::Elements(pixels(&f.dot) * BATCH as u64));
+    group.bench_function("rust/linear", |b| {
+        b.iter(|| {
+            batch
+                .chunks_exact(f.dot.buf().len())
+                .map(|img| {
+                    let img = imgref::ImgRef::new(img, f.dot.width(), f.dot.height());
+                    analyze::analyze_dot(black_box(&img), false).points.len()
+                })
+                .sum::<usize>()
+        })
+    });
+    #[cfg(feature = "c-reference")]
+    group.bench_function("c/linear", |b| {
+        b.iter(|| c_shim::analyze_dot_batch(black_box(&batch), BATCH, &f.dot, false))
+    });
+    group.finish();
+
+    let mut group = c.benchmark_group("score_against_all");
+    group.bench_function("upscale", |b| {
+        b.iter(|| score::score_against_all(black_box(&f.upscale)))
+    });
+    group.bench_function("downscale", |b| {
+        b.iter(|| score::score_against_all(black_box(&f.downscale)))
+    });
+    group.finish();
+
+    c.bench_function("graph_render", |b| {
+        b.iter(|| {
+            graph::render(
+                black_box(Some(&f.downscale)),
+                black_box(Some(&f.upscale)),
+                Some(KnownFilter::Lanczos3),
+            )
+        })
+    });
+
+    let mut canvas = graph::GraphCanvas::new();
+    c.bench_function("graph_render_canvas", |b| {
+        b.iter(|| {
+            canvas
+                .render(
+                    black_box(Some(&f.downscale)),
+                    black_box(Some(&f.upscale)),
+                    Some(KnownFilter::Lanczos3),
+                )
+                .buf()[0]
+        })
+    });
+}
+
+fn bench_reference(c: &mut Criterion) {
+    let mut group = c.benchmark_group("compute_weights");
+    for (name, src, dst) in [
+        ("upscale 15->555", 15, 555),
+        ("downscale 557->555", 557, 555),
+    ] {
+        group.bench_function(name, |b| {
+            b.iter(|| resamplescope::compute_weights(KnownFilter::Lanczos3, black_box(src), dst))
+        });
+    }
+    group.finish();
+
+    let mut group = c.benchmark_group("perfect_resize");
+    let (dot_w, dot_h) = analyze::dot_target();
+    group.throughput(Throughput::Elements((dot_w * dot_h) as u64));
+    for filter in [KnownFilter::Triangle, KnownFilter::Lanczos3] {
+        group.bench_function(filter.name(), |b| {
+            b.iter(|| {
+                resamplescope::perfect_resize(
+                    black_box(pattern::dot_pattern()),
+                    dot_w,
+                    dot_h,
+                    filter,
+                )
+            })
+        });
+        group.bench_function(format!("{} fast", filter.name()), |b| {
+            b.iter(|| {
+                resamplescope::perfect_resize_fast(
+                    black_box(pattern::dot_pattern()),
+                    dot_w,
+                    dot_h,
+                    filter,
+                )
+            })
+        });
+        group.bench_function(format!("{} parallel", filter.name()), |b| {
+            b.iter(|| {
+                resamplescope::perfect_resize_parallel(
+                    black_box(pattern::dot_pattern()),
+                    dot_w,
+                    dot_h,
+                    filter,
+                    None,
+                )
+            })
+        });
+    }
+    group.finish();
+
+    let a =
+        resamplescope::perfect_resize(pattern::dot_pattern(), dot_w, dot_h, KnownFilter::Lanczos3);
+    let b =
+        resamplescope::perfect_resize(pattern::dot_pattern(), dot_w, dot_h, KnownFilter::Mitchell);
+    let mut group = c.benchmark_group("ssim");
+    group.throughput(Throughput::Elements((dot_w * dot_h) as u64));
+    group.bench_function("dot 555x275", |bench| {
+        bench.iter(|| resamplescope::ssim(black_box(a.buf()), black_box(b.buf()), dot_w, dot_h))
+    });
+    group.bench_function("windowed dot 555x275", |bench| {
+        bench.iter(|| {
+            resamplescope::ssim_windowed(
+                black_box(a.buf()),
+                black_box(b.buf()),
+                dot_w,
+                dot_h,
+                resamplescope::SSIM_WINDOW,
+                Some(1),
+            )
+        })
+    });
+    group.finish();
+}
+
+#[cfg(feature = "c-reference")]
+mod c_shim {
+    use imgref::ImgVec;
+
+    unsafe extern "C" {
+        fn rs_analyze_dot(
+            resized: *const u8,
+            w: i32,
+            h: i32,
+            srgb: i32,
+            offsets: *mut f64,
+            weights: *mut f64,
+            out_count: *mut i32,
+        ) -> f64;
+
+        fn rs_analyze_line(
+            resized: *const u8,
+            w: i32,
+            h: i32,
+            srgb: i32,
+            offsets: *mut f64,
+            weights: *mut f64,
+            out_area: *mut f64,
+        ) -> f64;
+
+        fn rs_analyze_dot_batch(
+            images: *const u8,
+            n: i32,
+            w: i32,
+            h: i32,
+            srgb: i32,
+            offsets: *mut f64,
+            weights: *mut f64,
+            out_counts: *mut i32,
+        ) -> f64;
+    }
+
+    /// Upper bound on the dot analysis output (one point per strip and column).
+    fn dot_capacity(img: &ImgVec<u8>) -> usize {
+        img.width() * resamplescope::pattern::DOT_NUM_STRIPS
+    }
+
+    pub fn analyze_dot(img: &ImgVec<u8>, srgb: bool) -> (Vec<f64>, Vec<f64>, i32) {
+        let cap = dot_capacity(img);
+        let mut offsets = vec![0.0; cap];
+        let mut weights = vec![0.0; cap];
+        let mut count = 0;
+        unsafe {
+            rs_analyze_dot(
+                img.buf().as_ptr(),
+                img.width() as i32,
+                img.height() as i32,
+                srgb as i32,
+                offsets.as_mut_ptr(),
+                weights.as_mut_ptr(),
+                &mut count,
+            );
+        }
+        (offsets, weights, count)
+    }
+
+    /// `images` holds `n` images the size of `like`, back to back.
+    pub fn analyze_dot_batch(
+        images: &[u8],
+        n: usize,
+        like: &ImgVec<u8>,
+        srgb: bool,
+    ) -> (Vec<f64>, Vec<f64>, Vec<i32>) {
+        let cap = dot_capacity(like) * n;
+        let mut offsets = vec![0.0; cap];
+        let mut weights = vec![0.0; cap];
+        let mut counts = vec![0; n];
+        assert_eq!(images.len(), n * like.buf().len());
+        unsafe {
+            rs_analyze_dot_batch(
+                images.as_ptr(),
+                n as i32,
+                like.width() as i32,
+                like.height() as i32,
+                srgb as i32,
+                offsets.as_mut_ptr(),
+                weights.as_mut_ptr(),
+                counts.as_mut_ptr(),
+            );
+        }
+        (offsets, weights, counts)
+    }
+
+    pub fn analyze_line(img: &ImgVec<u8>, srgb: bool) -> (Vec<f64>, Vec<f64>, f64) {
+        let mut offsets = vec![0.0; img.width()];
+        let mut weights = vec![0.0; img.width()];
+        let mut area = 0.0;
+        unsafe {
+            rs_analyze_line(
+                img.buf().as_ptr(),
+                img.width() as i32,
+                img.height() as i32,
+                srgb as i32,
+                offsets.as_mut_ptr(),
+                weights.as_mut_ptr(),
+                &mut area,
+            );
+        }
+        (offsets, weights, area)
+    }
+}
+
+criterion_group!(benches, bench_analysis, bench_reference);
+criterion_main!(benches);
@@ -1,6 +1,7 @@
 fn main() {
     #[cfg(feature = "c-reference")]
     {
+        println!("cargo:rerun-if-changed=c_reference/rscope_shim.c");
         cc::Build::new()
             .file("c_reference/rscope_shim.c")
             .warnings(true)
@@ -7,6 +7,7 @@
 // into Rust tests for comparison against the Rust port.
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
@@ -92,45 +93,52 @@ static double c_srgb_to_linear(double v_srgb) {
     }
 }
 
-static double read_pixel(const uint8_t *buf, int stride, int x, int y, int srgb) {
-    double raw = (double)buf[y * stride + x];
+static double decode_pixel(int raw, int srgb) {
     if (srgb) {
         double srgb50_lin = c_srgb_to_linear(50.0 / 255.0);
         double srgb250_lin = c_srgb_to_linear(250.0 / 255.0);
-        double v_lin = c_srgb_to_linear(raw / 255.0);
+        double v_lin = c_srgb_to_linear((double)raw / 255.0);
         return (v_lin - srgb50_lin) * ((250.0 - 50.0) / (srgb250_lin - srgb50_lin)) + 50.0;
     }
-    return raw;
+    return (double)raw;
 }
 
-// ---------- Dot analysis (downscale) ----------
+// Fill lut[v] with the normalized weight (level - DARK) / (BRIGHT - DARK) of
+// every u8 pixel value, mirroring weight_lut() on the Rust side so that both
+// implementations decode pixels with identical arithmetic.
+static void build_weight_lut(double lut[256], int srgb) {
+    int v;
+    for (v = 0; v < 256; v++) {
+        lut[v] = (decode_pixel(v, srgb) - 50.0) / 200.0;
+    }
+}
 
-// Extract (offset, weight) scatter points from a resized dot pattern.
-// This is a direct port of plot_strip() from rscope.c.
-//
-// Parameters:
-//   resized   - the resized dot pattern image (grayscale, row-major)
-//   w, h      - dimensions of resized image
-//   srgb      - apply sRGB correction (0 or 1)
-//   offsets   - output array for x-offsets (must hold w * DOTIMG_NUMSTRIPS entries)
-//   weights   - output array for weights (must hold w * DOTIMG_NUMSTRIPS entries)
-//   out_count - number of valid points written
-//
-// Returns scale_factor used.
-double rs_analyze_dot(const uint8_t *resized, int w, int h,
-                      int srgb,
-                      double *offsets, double *weights, int *out_count) {
-    double scale_factor = (double)w / (double)DOTIMG_SRC_WIDTH;
-    int count = 0;
-    int strip, dstpos, k, row;
+// ---------- Dot analysis (downscale) ----------
 
-    (void)h; // height must be DOTIMG_DST_HEIGHT, validated by caller
+// Nearest-dot offset of every (strip, dstpos) that is close enough to a dot
+// to be plotted. Depends only on the image width, so a batch computes it once.
+// This is the C counterpart of DotOffsetTable on the Rust side.
+typedef struct {
+    int count;
+    int *strip;
+    int *dstpos;
+    double *offset;
+} dot_offsets;
+
+static int build_dot_offsets(dot_offsets *t, int w, double scale_factor) {
+    int strip, dstpos, k;
+    int cap = w * DOTIMG_NUMSTRIPS;
+
+    t->count = 0;
+    t->strip = (int *)malloc(sizeof(int) * cap);
+    t->dstpos = (int *)malloc(sizeof(int) * cap);
+    t->offset = (double *)malloc(sizeof(double) * cap);
+    if (!t->strip || !t->dstpos || !t->offset) return 0;
 
     for (strip = 0; strip < DOTIMG_NUMSTRIPS; strip++) {
         for (dstpos = 0; dstpos < w; dstpos++) {
             double offset = 10000.0;
             double tmp_offset;
-            double tot, weight;
             double zp;
 
             // Find nearest zero-point (matching rscope.c plot_strip exactly).
@@ -148,51 +156,120 @@ double rs_analyze_dot(const uint8_t *resized, int w, int h,
             // Skip points too far from any dot.
             if (fabs(offset) > scale_factor * DOTIMG_HCENTER) continue;
 
-            // Sum vertically across the strip.
-            tot = 0.0;
-            for (row = 0; row < DOTIMG_STRIPHEIGHT; row++) {
-                int y = DOTIMG_STRIPHEIGHT * strip + row;
-                double v = read_pixel(resized, w, dstpos, y, srgb);
-                tot += (v - 50.0);
-            }
+            t->strip[t->count] = strip;
+            t->dstpos[t->count] = dstpos;
+            t->offset[t->count] = offset;
+            t->count++;
+        }
+    }
+    return 1;
+}
 
-            // Normalize to weight.
-            weight = tot / 200.0;
+static void free_dot_offsets(dot_offsets *t) {
+    free(t->strip);
+    free(t->dstpos);
+    free(t->offset);
+}
 
-            if (scale_factor < 1.0) {
-                weight /= scale_factor;
-            } else {
-                offset /= scale_factor;
-            }
+// Plot one resized dot image through a prebuilt offset table and LUT.
+static void analyze_dot_one(const uint8_t *resized, int w, const dot_offsets *t,
+                            const double lut[256], double scale_factor,
+                            double *offsets, double *weights) {
+    int i, row;
+
+    for (i = 0; i < t->count; i++) {
+        int strip = t->strip[i];
+        int dstpos = t->dstpos[i];
+        double offset = t->offset[i];
+        double tot = 0.0;
+        double weight;
+
+        // Sum normalized weights vertically across the strip.
+        for (row = 0; row < DOTIMG_STRIPHEIGHT; row++) {
+            int y = DOTIMG_STRIPHEIGHT * strip + row;
+            tot += lut[resized[y * w + dstpos]];
+        }
+        weight = tot;
 
-            offsets[count] = offset;
-            weights[count] = weight;
-            count++;
+        if (scale_factor < 1.0) {
+            weight /= scale_factor;
+        } else {
+            offset /= scale_factor;
         }
+
+        offsets[i] = offset;
+        weights[i] = weight;
     }
+}
 
-    *out_count = count;
+// Analyze n resized dot patterns in one call, building the offset table and
+// the weight LUT once.
+//
+// Parameters:
+//   images     - n resized dot pattern images back to back (each w * h bytes,
+//                grayscale, row-major)
+//   n          - number of images
+//   w, h       - dimensions of every image
+//   srgb       - apply sRGB correction (0 or 1)
+//   offsets    - output x-offsets; image i starts at i * w * DOTIMG_NUMSTRIPS
+//   weights    - output weights, laid out like offsets
+//   out_counts - receives the number of points written for each image
+//
+// Returns scale_factor used, or -1.0 if the offset table cannot be allocated,
+// in which case every out_counts entry is set to 0.
+double rs_analyze_dot_batch(const uint8_t *images, int n, int w, int h,
+                            int srgb,
+                            double *offsets, double *weights, int *out_counts) {
+    double scale_factor = (double)w / (double)DOTIMG_SRC_WIDTH;
+    size_t stride = (size_t)w * DOTIMG_NUMSTRIPS;
+    dot_offsets table;
+    double lut[256];
+    int i;
+
+    // Height must be DOTIMG_DST_HEIGHT, validated by caller.
+
+    if (!build_dot_offsets(&table, w, scale_factor)) {
+        free_dot_offsets(&table);
+        for (i = 0; i < n; i++) out_counts[i] = 0;
+        return -1.0;
+    }
+    build_weight_lut(lut, srgb);
+
+    for (i = 0; i < n; i++) {
+        analyze_dot_one(images + (size_t)i * w * h, w, &table, lut, scale_factor,
+                        offsets + i * stride, weights + i * stride);
+        out_counts[i] = table.count;
+    }
+
+    free_dot_offsets(&table);
     return scale_factor;
 }
 
-// ---------- Line analysis (upscale) ----------
-
-// Extract (offset, weight) connected curve from a resized line pattern.
-// This is a direct port of run_lineimg_1file() + gr_lineimg_graph_main() from rscope.c.
+// Extract (offset, weight) scatter points from a resized dot pattern.
+// This is a direct port of plot_strip() from rscope.c.
 //
 // Parameters:
-//   resized   - the resized line pattern image (grayscale, row-major)
+//   resized   - the resized dot pattern image (grayscale, row-major)
 //   w, h      - dimensions of resized image
 //   srgb      - apply sRGB correction (0 or 1)
-//   offsets   - output array for x-offsets (must hold w entries)
-//   weights   - output array for weights (must hold w entries)
-//   out_area  - computed area (sum / scale_factor)
+//   offsets   - output array for x-offsets (must hold w * DOTIMG_NUMSTRIPS entries)
+//   weights   - output array for weights (must hold w * DOTIMG_NUMSTRIPS entries)
+//   out_count - number of valid points written
 //
-// Returns scale_factor used.
-double rs_analyze_line(const uint8_t *resized, int w, int h,
-                       int srgb,
-                       double *offsets, double *weights, double *out_area) {
-    double scale_factor = (double)w / (double)LINEIMG_SRC_WIDTH;
+// Returns scale_factor used, or -1.0 if the offset table cannot be allocated,
+// in which case *out_count is set to 0.
+double rs_analyze_dot(const uint8_t *resized, int w, int h,
+                      int srgb,
+                      double *offsets, double *weights, int *out_count) {
+    return rs_analyze_dot_batch(resized, 1, w, h, srgb, offsets, weights, out_count);
+}
+
+// ---------- Line analysis (upscale) ----------
+
+// Plot one resized line image through a prebuilt LUT; returns its area.
+static double analyze_line_one(const uint8_t *resized, int w, int h,
+                               const double lut[256], double scale_factor,
+                               double *offsets, double *weights) {
     int scanline = h / 2;
     double tot = 0.0;
     int i;
@@ -201,7 +278,7 @@ double rs_analyze_line(const uint8_t *resized, int w, int h,
     // The C code reads: scanline + (i%3) - 1
     for (i = 0; i < w; i++) {
         int y;
-        double v, weight, offset;
+        double weight, offset;
 
         if (h >= 3) {
             y = scanline + (i % 3) - 1;
@@ -211,8 +288,7 @@ double rs_analyze_line(const uint8_t *resized, int w, int h,
             y = scanline;
         }
 
-        v = read_pixel(resized, w, i, y, srgb);
-        weight = (v - 50.0) / 200.0;
+        weight = lut[resized[y * w + i]];
         tot += weight;
 
         offset = 0.5 + (double)i - ((double)w) / 2.0;
@@ -227,10 +303,57 @@ double rs_analyze_line(const uint8_t *resized, int w, int h,
         weights[i] = weight;
     }
 
-    *out_area = tot / scale_factor;
+    return tot / scale_factor;
+}
+
+// Analyze n resized line patterns in one call, building the weight LUT once.
+//
+// Parameters:
+//   images    - n resized line pattern images back to back (each w * h bytes,
+//               grayscale, row-major)
+//   n         - number of images
+//   w, h      - dimensions of every image
+//   srgb      - apply sRGB correction (0 or 1)
+//   offsets   - output x-offsets; image i starts at i * w
+//   weights   - output weights, laid out like offsets
+//   out_areas - receives the computed area of each image
+//
+// Returns scale_factor used.
+double rs_analyze_line_batch(const uint8_t *images, int n, int w, int h,
+                             int srgb,
+                             double *offsets, double *weights, double *out_areas) {
+    double scale_factor = (double)w / (double)LINEIMG_SRC_WIDTH;
+    double lut[256];
+    int i;
+
+    build_weight_lut(lut, srgb);
+
+    for (i = 0; i < n; i++) {
+        out_areas[i] = analyze_line_one(images + (size_t)i * w * h, w, h, lut,
+                                        scale_factor, offsets + (size_t)i * w,
+                                        weights + (size_t)i * w);
+    }
     return scale_factor;
 }
 
+// Extract (offset, weight) connected curve from a resized line pattern.
+// This is a direct port of run_lineimg_1file() + gr_lineimg_graph_main() from rscope.c.
+//
+// Parameters:
+//   resized   - the resized line pattern image (grayscale, row-major)
+//   w, h      - dimensions of resized image
+//   srgb      - apply sRGB correction (0 or 1)
+//   offsets   - output array for x-offsets (must hold w entries)
+//   weights   - output array for weights (must hold w entries)
+//   out_area  - computed area (sum / scale_factor)
+//
+// Returns scale_factor used.
+double rs_analyze_line(const uint8_t *resized, int w, int h,
+                       int srgb,
+                       double *offsets, double *weights, double *out_area) {
+    return rs_analyze_line_batch(resized, 1, w, h, srgb, offsets, weights, out_area);
+}
+
 // ---------- Dimension queries ----------
 
 int rs_dot_src_width(void)  { return DOTIMG_SRC_WIDTH; }
@@ -0,0 +1,295 @@
+//! Repeated probing of noisy resizers, stopping once the match settles.
+//!
+//! Dithering or stochastic resizers give a slightly different curve on every
+//! call. [`analyze_adaptive`] repeats the dot and line probes, folds every
+//! curve into a running per-point mean and variance (Welford's method), and
+//! re-scores the mean curves after each round. It stops as soon as the
+//! leading filter is unchanged from the previous round and the standard error
+//! of its correlation is at most [`AdaptiveConfig::tolerance`], or after
+//! [`AdaptiveConfig::max_probes`] rounds.
+//!
+//! The standard error comes from the running variance, not from how much the
+//! correlation happened to move: for each curve, `ε` is the norm of the
+//! per-point standard errors `sqrt(variance / rounds)` relative to the norm of
+//! the centered mean weights. To first order, noise of relative size `ε`
+//! moves a correlation `r` by at most `ε * sqrt(1 - r²)`, and the larger of
+//! that bound over the two curves is compared with the tolerance.
+//!
+//! One round is one dot and one line resize. A single round cannot show that
+//! a resizer is deterministic, so the stop rule needs at least two. A
+//! deterministic resizer has zero variance and stops at the second round.
+
+use crate::analyze::FilterCurve;
+use crate::edge;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFn};
+
+/// Configuration for [`analyze_adaptive`].
+#[derive(Debug, Clone)]
+pub struct AdaptiveConfig {
+    /// Settings for each probe. Edge detection, if on, runs once.
+    pub analysis: AnalysisConfig,
+    /// Fewest rounds (one dot and one line resize each) before the stop rule
+    /// is checked. Values below 2 are treated as 2.
+    pub min_probes: usize,
+    /// Most rounds to run, whether or not the match has settled.
+    pub max_probes: usize,
+    /// Largest standard error of the leading correlation that still counts as
+    /// settled; see the [module docs](self).
+    pub tolerance: f64,
+}
+
+impl Default for AdaptiveConfig {
+    fn default() -> Self {
+        Self {
+            analysis: AnalysisConfig::default(),
+            min_probes: 2,
+            max_probes: 64,
+            tolerance: 1e-4,
+        }
+    }
+}
+
+/// Result of [`analyze_adaptive`].
+#[derive(Debug, Clone)]
+pub struct AdaptiveResult {
+    /// The analysis of the mean curves.
+    pub result: AnalysisResult,
+    /// Per-point sample variance of the downscale curve, parallel to
+    /// `result.downscale_curve.points`. All zero for a deterministic resizer.
+    pub downscale_variance: Vec<f64>,
+    /// Per-point sample variance of the upscale curve, parallel to
+    /// `result.upscale_curve.points`.
+    pub upscale_variance: Vec<f64>,
+    /// Number of rounds run. Each round is two resize calls, one dot and one
+    /// line, so the resizer was called `2 * probes` times (plus one edge
+    /// probe if edge detection is on).
+    pub probes: usize,
+    /// True if the stop rule was met before `max_probes`.
+    pub converged: bool,
+    /// Leading correlation after each round.
+    pub correlation_history: Vec<f64>,
+}
+
+impl AdaptiveResult {
+    /// Standard error of the mean of every downscale curve point.
+    pub fn downscale_std_error(&self) -> Vec<f64> {
+        std_error(&self.downscale_variance, self.probes)
+    }
+
+    /// Standard error of the mean of every upscale curve point.
+    pub fn upscale_std_error(&self) -> Vec<f64> {
+        std_error(&self.upscale_variance, self.probes)
+    }
+}
+
+fn std_error(variance: &[f64], count: usize) -> Vec<f64> {
+    let n = count as f64;
+    variance.iter().map(|v| (v / n).sqrt()).collect()
+}
+
+/// Running mean and variance of the weights of a sequence of curves with the
+/// same offsets.
+struct RunningCurve {
+    curve: FilterCurve,
+    m2: Vec<f64>,
+    area_sum: f64,
+    count: usize,
+}
+
+impl RunningCurve {
+    fn new(first: FilterCurve) -> Self {
+        Self {
+            m2: vec![0.0; first.points.len()],
+            area_sum: first.area,
+            curve: first,
+            count: 1,
+        }
+    }
+
+    fn add(&mut self, sample: &FilterCurve) -> Result<(), Error> {
+        if sample.points.len() != self.curve.points.len() {
+            return Err(Error::NoData);
+        }
+        self.count += 1;
+        let n = self.count as f64;
+        for ((mean, m2), &(_, w)) in self
+            .curve
+            .points
+            .iter_mut()
+            .zip(&mut self.m2)
+            .zip(&sample.points)
+        {
+            let delta = w - mean.1;
+            mean.1 += delta / n;
+            *m2 += delta * (w - mean.1);
+        }
+        self.area_sum += sample.area;
+        self.curve.area = self.area_sum / n;
+        Ok(())
+    }
+
+    fn variance(&self) -> Vec<f64> {
+        let d = (self.count.max(2) - 1) as f64;
+        self.m2.iter().map(|m| m / d).collect()
+    }
+
+    /// Norm of the standard errors of the mean weights, relative to the norm
+    /// of the centered mean weights (`ε` in the module docs). Zero for a flat
+    /// curve, which no further rounds can improve.
+    fn relative_std_error(&self) -> f64 {
+        let points = &self.curve.points;
+        let d = ((self.count.max(2) - 1) * self.count) as f64;
+        let err: f64 = self.m2.iter().map(|m| m / d).sum();
+        let mean = points.iter().map(|&(_, w)| w).sum::<f64>() / points.len().max(1) as f64;
+        let signal: f64 = points.iter().map(|&(_, w)| (w - mean) * (w - mean)).sum();
+        if signal == 0.0 {
+            0.0
+        } else {
+            (err / signal).sqrt()
+        }
+    }
+}
+
+/// [`analyze`](fn@crate::analyze) a noisy resizer by averaging repeated
+/// probes; see the [module docs](self).
+pub fn analyze_adaptive(
+    resize: &ResizeFn,
+    config: &AdaptiveConfig,
+) -> Result<AdaptiveResult, Error> {
+    let analysis = &config.analysis;
+    let max_probes = config.max_probes.max(1);
+    let min_probes = config.min_probes.max(2);
+
+    let mut down = RunningCurve::new(crate::probe_dot(resize, analysis)?);
+    let mut up = RunningCurve::new(crate::probe_line(resize, analysis)?);
+    let edge_mode = analysis
+        .detect_edges
+        .then(|| edge::detect_with(resize, analysis.line_probe));
+
+    let mut result = crate::assemble_result(down.curve.clone(), up.curve.clone(), edge_mode)?;
+    let mut history = vec![result.scores[0].correlation];
+    let mut converged = false;
+
+    while down.count < max_probes {
+        down.add(&crate::probe_dot(resize, analysis)?)?;
+        up.add(&crate::probe_line(resize, analysis)?)?;
+        let next = crate::assemble_result(down.curve.clone(), up.curve.clone(), edge_mode)?;
+        let r = next.scores[0].correlation;
+        let eps = down.relative_std_error().max(up.relative_std_error());
+        let settled = result.scores[0].filter == next.scores[0].filter
+            && eps * (1.0 - r * r).max(0.0).sqrt() <= config.tolerance;
+        history.push(next.scores[0].correlation);
+        result = next;
+        if settled && down.count >= min_probes {
+            converged = true;
+            break;
+        }
+    }
+
+    Ok(AdaptiveResult {
+        result,
+        downscale_variance: down.variance(),
+        upscale_variance: up.variance(),
+        probes: down.count,
+        converged,
+        correlation_history: history,
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::KnownFilter;
+    use crate::test_util::lanczos3;
+    use imgref::{ImgRef, ImgVec};
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    static SEED: AtomicU64 = AtomicU64::new(1);
+
+    /// Lanczos3 with up to +-3 levels of fresh noise on every call.
+    fn dithered(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        let mut state = SEED.fetch_add(0x9e37_79b9_7f4a_7c15, Ordering::Relaxed);
+        let mut out = lanczos3(src, w, h);
+        for v in out.buf_mut() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            let noise = (state % 7) as i16 - 3;
+            *v = (*v as i16 + noise).clamp(0, 255) as u8;
+        }
+        out
+    }
+
+    #[test]
+    fn deterministic_resizer_stops_at_two_probes() {
+        let adaptive = analyze_adaptive(&lanczos3, &AdaptiveConfig::default()).unwrap();
+        assert_eq!(adaptive.probes, 2);
+        assert!(adaptive.converged);
+        assert!(adaptive.upscale_variance.iter().all(|&v| v == 0.0));
+        assert!(adaptive.downscale_variance.iter().all(|&v| v == 0.0));
+
+        let single = crate::analyze(&lanczos3, &AdaptiveConfig::default().analysis).unwrap();
+        assert_eq!(adaptive.result.scores[0].filter, single.scores[0].filter);
+        assert_eq!(
+            adaptive.result.scores[0].correlation,
+            single.scores[0].correlation
+        );
+    }
+
+    #[test]
+    fn noisy_resizer_averages_until_settled() {
+        let config = AdaptiveConfig {
+            max_probes: 200,
+            ..Default::default()
+        };
+        let adaptive = analyze_adaptive(&dithered, &config).unwrap();
+        assert!(adaptive.converged);
+        assert!(adaptive.probes > 2, "{} probes", adaptive.probes);
+        assert_eq!(adaptive.correlation_history.len(), adaptive.probes);
+        assert_eq!(
+            adaptive.result.best_match().unwrap().filter,
+            KnownFilter::Lanczos3
+        );
+        assert!(adaptive.upscale_variance.iter().any(|&v| v > 0.0));
+        assert_eq!(
+            adaptive.upscale_std_error().len(),
+            adaptive.result.upscale_curve.as_ref().unwrap().points.len()
+        );
+        assert_eq!(
+            adaptive.downscale_std_error().len(),
+            adaptive
+                .result
+                .downscale_curve
+                .as_ref()
+                .unwrap()
+                .points
+                .len()
+        );
+
+        // The average is closer to the noiseless curve than one probe is.
+        let clean = crate::analyze(&lanczos3, &config.analysis).unwrap();
+        let single = crate::analyze(&dithered, &config.analysis).unwrap();
+        let err = |r: &AnalysisResult| {
+            let c = r.upscale_curve.as_ref().unwrap();
+            let reference = clean.upscale_curve.as_ref().unwrap();
+            c.points
+                .iter()
+                .zip(&reference.points)
+                .map(|(a, b)| (a.1 - b.1).powi(2))
+                .sum::<f64>()
+        };
+        assert!(err(&adaptive.result) < err(&single));
+    }
+
+    #[test]
+    fn max_probes_caps_the_run() {
+        let config = AdaptiveConfig {
+            max_probes: 3,
+            tolerance: 0.0,
+            ..Default::default()
+        };
+        let adaptive = analyze_adaptive(&dithered, &config).unwrap();
+        assert_eq!(adaptive.probes, 3);
+        assert!(!adaptive.converged);
+    }
+}
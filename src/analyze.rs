@@ -1,8 +1,14 @@
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex, OnceLock};
+
 use imgref::ImgRef;
 
+use crate::Error;
+use crate::pixel::ProbePixel;
+
 use crate::pattern::{
-    BRIGHT, DARK, DOT_DST_HEIGHT, DOT_DST_WIDTH, DOT_HCENTER, DOT_HPIXELSPAN, DOT_NUM_STRIPS,
-    DOT_SRC_WIDTH, DOT_STRIP_HEIGHT, LINE_DST_HEIGHT, LINE_DST_WIDTH, LINE_SRC_WIDTH,
+    BRIGHT, DARK, DOT_DST_HEIGHT, DOT_DST_WIDTH, DOT_STRIP_HEIGHT, LINE_DST_HEIGHT, LINE_DST_WIDTH,
+    ProbeGeometry,
 };
 
 /// A reconstructed filter curve from analysis.
@@ -19,7 +25,112 @@ pub struct FilterCurve {
     pub is_scatter: bool,
 }
 
-fn srgb_to_linear(v: f64) -> f64 {
+impl FilterCurve {
+    /// A [`CompactCurve`] with scatter points averaged into `bin_width`-wide
+    /// bins. Connected (line) curves are already one point per output pixel
+    /// and are kept point for point.
+    pub fn binned(&self, bin_width: f64) -> CompactCurve {
+        let binned;
+        let (points, bin_width) = if self.is_scatter {
+            binned = crate::score::bin_scatter(&self.points, bin_width);
+            (&binned[..], bin_width)
+        } else {
+            (&self.points[..], 0.0)
+        };
+        CompactCurve {
+            offsets: points.iter().map(|p| p.0 as f32).collect(),
+            weights: points.iter().map(|p| p.1 as f32).collect(),
+            bin_width,
+            area: self.area,
+            scale_factor: self.scale_factor,
+            is_scatter: self.is_scatter,
+        }
+    }
+
+    /// [`binned`](Self::binned) at the bin width scoring uses,
+    /// [`SCORE_BIN_WIDTH`](crate::score::SCORE_BIN_WIDTH), so scoring the
+    /// compact curve sees the same bins as scoring this one.
+    pub fn compact(&self) -> CompactCurve {
+        self.binned(crate::score::SCORE_BIN_WIDTH)
+    }
+
+    /// Heap bytes held by `points`.
+    pub fn heap_bytes(&self) -> usize {
+        self.points.capacity() * std::mem::size_of::<(f64, f64)>()
+    }
+}
+
+/// A [`FilterCurve`] stored pre-binned, in `f32`, with offsets and weights in
+/// separate arrays.
+///
+/// A dot curve of ~13k scatter points (208 KiB) becomes a few hundred bins
+/// (a few KiB); see [`FilterCurve::binned`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct CompactCurve {
+    offsets: Box<[f32]>,
+    weights: Box<[f32]>,
+    bin_width: f64,
+    /// Integral of the filter, as in [`FilterCurve::area`].
+    pub area: f64,
+    /// Scale factor used: dst_width / src_width.
+    pub scale_factor: f64,
+    /// True if this came from a scatter (dot) curve.
+    pub is_scatter: bool,
+}
+
+impl CompactCurve {
+    /// Point offsets (bin centers for scatter curves), ascending.
+    pub fn offsets(&self) -> &[f32] {
+        &self.offsets
+    }
+
+    /// Point weights, parallel to [`offsets`](Self::offsets).
+    pub fn weights(&self) -> &[f32] {
+        &self.weights
+    }
+
+    /// Width of the bins the points were averaged into; 0 if the points were
+    /// kept as measured.
+    pub fn bin_width(&self) -> f64 {
+        self.bin_width
+    }
+
+    /// Number of points.
+    pub fn len(&self) -> usize {
+        self.offsets.len()
+    }
+
+    /// True if there are no points.
+    pub fn is_empty(&self) -> bool {
+        self.offsets.is_empty()
+    }
+
+    /// `(offset, weight)` pairs, widened to `f64`.
+    pub fn points(&self) -> impl ExactSizeIterator<Item = (f64, f64)> + '_ {
+        self.offsets
+            .iter()
+            .zip(&self.weights)
+            .map(|(&x, &w)| (x as f64, w as f64))
+    }
+
+    /// Expand back into a [`FilterCurve`] of the binned points, e.g. for
+    /// [`graph::render`](crate::graph::render).
+    pub fn to_curve(&self) -> FilterCurve {
+        FilterCurve {
+            points: self.points().collect(),
+            area: self.area,
+            scale_factor: self.scale_factor,
+            is_scatter: self.is_scatter,
+        }
+    }
+
+    /// Heap bytes held by the point arrays.
+    pub fn heap_bytes(&self) -> usize {
+        (self.offsets.len() + self.weights.len()) * std::mem::size_of::<f32>()
+    }
+}
+
+pub(crate) fn srgb_to_linear(v: f64) -> f64 {
     if v <= 0.04045 {
         v / 12.92
     } else {
@@ -27,10 +138,10 @@ fn srgb_to_linear(v: f64) -> f64 {
     }
 }
 
-/// Read a pixel value, optionally applying sRGB correction.
+/// Decode a raw pixel value, optionally applying sRGB correction.
 /// Returns a value in the range where DARK=50 and BRIGHT=250.
-fn read_pixel(img: &ImgRef<'_, u8>, x: usize, y: usize, srgb: bool) -> f64 {
-    let raw = img.buf()[y * img.stride() + x] as f64;
+fn decode_pixel(raw: u8, srgb: bool) -> f64 {
+    let raw = raw as f64;
     if srgb {
         let srgb50_lin = srgb_to_linear(50.0 / 255.0);
         let srgb250_lin = srgb_to_linear(250.0 / 255.0);
@@ -42,59 +153,261 @@ fn read_pixel(img: &ImgRef<'_, u8>, x: usize, y: usize, srgb: bool) -> f64 {
     }
 }
 
-/// Reconstruct the filter curve from a resized dot pattern image (downscale analysis).
+/// Normalized filter weight `(level - DARK) / (BRIGHT - DARK)` for every
+/// possible `u8` pixel value, where `level` is the (optionally sRGB-linearized)
+/// pixel value.
+pub type WeightLut = [f64; 256];
+
+fn build_weight_lut(srgb: bool) -> WeightLut {
+    let mut lut = [0.0; 256];
+    for (raw, weight) in lut.iter_mut().enumerate() {
+        *weight = (decode_pixel(raw as u8, srgb) - DARK as f64) / (BRIGHT as f64 - DARK as f64);
+    }
+    lut
+}
+
+/// The shared pixel-to-weight table for linear (`srgb == false`) or sRGB input,
+/// built on first use.
 ///
-/// The dot pattern has 25 strips, each with bright dots at phase-offset positions.
-/// By analyzing where each output pixel falls relative to the nearest dot,
-/// we reconstruct the filter kernel as a scatter plot.
-pub fn analyze_dot(img: &ImgRef<'_, u8>, srgb: bool) -> FilterCurve {
-    let w = img.width();
-    let h = img.height();
-    let scale_factor = w as f64 / DOT_SRC_WIDTH as f64;
+/// Decoding a pixel during analysis is a single table load; the C reference shim
+/// builds the same table the same way so both stay in lockstep.
+pub fn weight_lut(srgb: bool) -> &'static WeightLut {
+    static LINEAR: OnceLock<WeightLut> = OnceLock::new();
+    static SRGB: OnceLock<WeightLut> = OnceLock::new();
+    if srgb {
+        SRGB.get_or_init(|| build_weight_lut(true))
+    } else {
+        LINEAR.get_or_init(|| build_weight_lut(false))
+    }
+}
 
-    assert_eq!(
-        h, DOT_DST_HEIGHT,
-        "dot image height must be {DOT_DST_HEIGHT}"
-    );
+/// Sum every strip of a resized dot pattern vertically, one full row at a time.
+///
+/// Returns `strips` rows of `img.width()` totals (strip-major), each the
+/// sum of the normalized weights of the strip's rows. Rows are added in
+/// top-to-bottom order, so every total matches a column-wise walk exactly.
+fn accumulate_strips<T: Copy>(
+    img: &ImgRef<'_, T>,
+    strips: usize,
+    decode: impl Fn(T) -> f64,
+) -> Vec<f64> {
+    let w = img.width();
+    let mut sums = vec![0.0_f64; strips * w];
+
+    for (strip, strip_sums) in sums.chunks_exact_mut(w.max(1)).enumerate() {
+        for row in 0..DOT_STRIP_HEIGHT {
+            let y = DOT_STRIP_HEIGHT * strip + row;
+            let src_row = &img.buf()[y * img.stride()..][..w];
+            for (tot, &raw) in strip_sums.iter_mut().zip(src_row) {
+                *tot += decode(raw);
+            }
+        }
+    }
 
-    let mut points = Vec::new();
+    sums
+}
 
-    for strip in 0..DOT_NUM_STRIPS {
-        for dstpos in 0..w {
-            // Find nearest zero-point for this strip and output pixel.
-            let mut offset = 10000.0_f64;
+/// Nearest-dot offsets for every strip and output column of a dot pattern
+/// resized to one particular width.
+///
+/// The offsets depend only on the output width (and the [`ProbeGeometry`] of
+/// the pattern), so they are computed once per width (see [`dot_offset_table`])
+/// and shared by every [`analyze_dot`] call.
+#[derive(Debug)]
+pub struct DotOffsetTable {
+    width: usize,
+    /// `(dstpos, offset)` for every output column within reach of a dot, strip
+    /// by strip. Offsets are in output pixels, before any scale correction.
+    entries: Vec<(usize, f64)>,
+    /// Start of each strip's run in `entries`, plus a final end marker.
+    strip_starts: Vec<usize>,
+}
 
-            let mut k = DOT_HCENTER + strip;
-            while k < DOT_SRC_WIDTH - DOT_HCENTER {
-                // Convert source dot position to target image coordinates.
-                let zp = scale_factor * (k as f64 + 0.5 - DOT_SRC_WIDTH as f64 / 2.0)
-                    + (w as f64 / 2.0)
-                    - 0.5;
+impl DotOffsetTable {
+    /// Build the table for a dot pattern resized to `width` columns.
+    pub fn new(width: usize) -> Self {
+        Self::with_geometry(&ProbeGeometry::DEFAULT, width)
+    }
 
-                let tmp_offset = dstpos as f64 - zp;
+    /// Build the table for the dot pattern of `geometry` resized to `width`
+    /// columns. Only the dot fields of `geometry` are used.
+    ///
+    /// # Panics
+    ///
+    /// If [`ProbeGeometry::validate`] rejects `geometry`.
+    pub fn with_geometry(geometry: &ProbeGeometry, width: usize) -> Self {
+        if let Err(e) = geometry.validate() {
+            panic!("{e}");
+        }
+        let src_width = geometry.dot_src_width;
+        let span = geometry.dot_span;
+        let hcenter = geometry.dot_hcenter();
+        let strips = geometry.dot_strips();
+        let scale_factor = width as f64 / src_width as f64;
+        let mut entries = Vec::new();
+        let mut strip_starts = Vec::with_capacity(strips + 1);
+
+        for strip in 0..strips {
+            strip_starts.push(entries.len());
+
+            for dstpos in 0..width {
+                // Find nearest zero-point for this strip and output pixel.
+                let mut offset = 10000.0_f64;
+
+                let mut k = hcenter + strip;
+                while k < src_width.saturating_sub(hcenter) {
+                    // Convert source dot position to target image coordinates.
+                    let zp = scale_factor * (k as f64 + 0.5 - src_width as f64 / 2.0)
+                        + (width as f64 / 2.0)
+                        - 0.5;
+
+                    let tmp_offset = dstpos as f64 - zp;
+
+                    if tmp_offset.abs() < offset.abs() {
+                        offset = tmp_offset;
+                    }
+
+                    k += span;
+                }
 
-                if tmp_offset.abs() < offset.abs() {
-                    offset = tmp_offset;
+                // Skip points too far from any dot.
+                if offset.abs() > scale_factor * hcenter as f64 {
+                    continue;
                 }
 
-                k += DOT_HPIXELSPAN;
+                entries.push((dstpos, offset));
             }
+        }
+        strip_starts.push(entries.len());
 
-            // Skip points too far from any dot.
-            if offset.abs() > scale_factor * DOT_HCENTER as f64 {
-                continue;
-            }
+        Self {
+            width,
+            entries,
+            strip_starts,
+        }
+    }
 
-            // Sum vertically across the strip to undo vertical blur.
-            let mut tot = 0.0;
-            for row in 0..DOT_STRIP_HEIGHT {
-                let y = DOT_STRIP_HEIGHT * strip + row;
-                let v = read_pixel(img, dstpos, y, srgb);
-                tot += v - DARK as f64;
-            }
+    /// The output width this table was built for.
+    pub fn width(&self) -> usize {
+        self.width
+    }
+
+    /// Total number of `(dstpos, offset)` entries across all strips.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// True if no output column is within reach of a dot.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Number of strips in the table.
+    pub fn strips(&self) -> usize {
+        self.strip_starts.len() - 1
+    }
+
+    /// The `(dstpos, offset)` entries of one strip, in increasing `dstpos` order.
+    pub fn strip(&self, strip: usize) -> &[(usize, f64)] {
+        &self.entries[self.strip_starts[strip]..self.strip_starts[strip + 1]]
+    }
+}
+
+/// Most offset tables [`dot_offset_table_for`] keeps cached at once. Each is
+/// a few hundred KB for a typical probe width.
+pub const MAX_CACHED_OFFSET_TABLES: usize = 64;
+
+/// The shared [`DotOffsetTable`] for `width`, built on first use and cached
+/// (see [`dot_offset_table_for`]).
+pub fn dot_offset_table(width: usize) -> Arc<DotOffsetTable> {
+    dot_offset_table_for(&ProbeGeometry::DEFAULT, width).expect("default geometry is valid")
+}
+
+/// [`dot_offset_table`] for the dot pattern of `geometry`. Tables are cached
+/// per pattern (`dot_src_width`, `dot_span`) and output width, up to
+/// [`MAX_CACHED_OFFSET_TABLES`] of them; past that, an arbitrary table is
+/// dropped from the cache (callers holding it keep their `Arc`).
+///
+/// The cache lock is not held while a table is built, so threads asking for
+/// different widths build in parallel. Two threads racing on the same new
+/// width may both build it; the first to finish is kept and both get it.
+///
+/// Returns [`Error::InvalidGeometry`] if [`ProbeGeometry::validate`] rejects
+/// `geometry`.
+pub fn dot_offset_table_for(
+    geometry: &ProbeGeometry,
+    width: usize,
+) -> Result<Arc<DotOffsetTable>, Error> {
+    type Key = (usize, usize, usize);
+    static TABLES: OnceLock<Mutex<HashMap<Key, Arc<DotOffsetTable>>>> = OnceLock::new();
+    geometry.validate()?;
+    let tables = TABLES.get_or_init(Default::default);
+    let lock = || tables.lock().unwrap_or_else(|e| e.into_inner());
+    let key = (geometry.dot_src_width, geometry.dot_span, width);
+    if let Some(table) = lock().get(&key) {
+        return Ok(Arc::clone(table));
+    }
+
+    let built = Arc::new(DotOffsetTable::with_geometry(geometry, width));
+    let mut tables = lock();
+    if tables.len() >= MAX_CACHED_OFFSET_TABLES
+        && !tables.contains_key(&key)
+        && let Some(&evict) = tables.keys().next()
+    {
+        tables.remove(&evict);
+    }
+    Ok(Arc::clone(tables.entry(key).or_insert(built)))
+}
+
+/// Reconstruct the filter curve from a resized dot pattern image (downscale analysis).
+///
+/// The dot pattern has 25 strips, each with bright dots at phase-offset positions.
+/// By analyzing where each output pixel falls relative to the nearest dot,
+/// we reconstruct the filter kernel as a scatter plot. The nearest-dot offsets come
+/// from the cached [`DotOffsetTable`] for the image width.
+///
+/// Works on any [`ProbePixel`] format; `u8` images decode through [`weight_lut`].
+pub fn analyze_dot<T: ProbePixel>(img: &ImgRef<'_, T>, srgb: bool) -> FilterCurve {
+    analyze_dot_with(img, srgb, &ProbeGeometry::DEFAULT)
+}
+
+/// [`analyze_dot`] for the dot pattern of `geometry`, resized to any width.
+///
+/// # Panics
+///
+/// If the image is not [`ProbeGeometry::dot_height`] rows tall, or if
+/// [`ProbeGeometry::validate`] rejects `geometry`.
+pub fn analyze_dot_with<T: ProbePixel>(
+    img: &ImgRef<'_, T>,
+    srgb: bool,
+    geometry: &ProbeGeometry,
+) -> FilterCurve {
+    let height = geometry.dot_height();
+    assert_eq!(img.height(), height, "dot image height must be {height}");
+
+    // Sum vertically across each strip to undo vertical blur.
+    let strip_sums = accumulate_strips(img, geometry.dot_strips(), T::weight_decoder(srgb));
+    dot_curve_from_strip_sums(geometry, img.width(), &strip_sums)
+}
 
-            // Convert to normalized weight.
-            let mut weight = tot / (BRIGHT as f64 - DARK as f64);
+/// The second half of [`analyze_dot_with`]: turn the strip-major vertical sums
+/// of a `w`-column dot image into the scatter curve.
+pub(crate) fn dot_curve_from_strip_sums(
+    geometry: &ProbeGeometry,
+    w: usize,
+    strip_sums: &[f64],
+) -> FilterCurve {
+    let scale_factor = w as f64 / geometry.dot_src_width as f64;
+    let offsets = match dot_offset_table_for(geometry, w) {
+        Ok(offsets) => offsets,
+        Err(e) => panic!("{e}"),
+    };
+    let mut points = Vec::with_capacity(offsets.len());
+
+    for strip in 0..offsets.strips() {
+        let sums = &strip_sums[strip * w..][..w];
+        for &(dstpos, mut offset) in offsets.strip(strip) {
+            let mut weight = sums[dstpos];
 
             if scale_factor < 1.0 {
                 // Downscale: compensate for pixel size reduction.
@@ -120,27 +433,58 @@ pub fn analyze_dot(img: &ImgRef<'_, u8>, srgb: bool) -> FilterCurve {
 ///
 /// The line pattern is a single bright column that, when upscaled, directly reveals
 /// the filter kernel shape as a connected curve.
-pub fn analyze_line(img: &ImgRef<'_, u8>, srgb: bool) -> FilterCurve {
-    let w = img.width();
-    let h = img.height();
-    let scale_factor = w as f64 / LINE_SRC_WIDTH as f64;
+///
+/// Works on any [`ProbePixel`] format; `u8` images decode through [`weight_lut`].
+pub fn analyze_line<T: ProbePixel>(img: &ImgRef<'_, T>, srgb: bool) -> FilterCurve {
+    analyze_line_with(img, srgb, &ProbeGeometry::DEFAULT)
+}
+
+/// [`analyze_line`] for the line pattern of `geometry`, resized to any size.
+/// Only `geometry.line_src_width` is used.
+pub fn analyze_line_with<T: ProbePixel>(
+    img: &ImgRef<'_, T>,
+    srgb: bool,
+    geometry: &ProbeGeometry,
+) -> FilterCurve {
+    let decode = T::weight_decoder(srgb);
+    line_curve(
+        geometry.line_src_width,
+        img.width(),
+        img.height(),
+        |y, i| decode(img.buf()[y * img.stride() + i]),
+    )
+}
+
+/// The row [`analyze_line`] reads column `i` from in an image `h` rows tall.
+///
+/// Reads cycle through the scanlines around the middle (±1 row) as a
+/// consistency check, matching the C source behavior.
+pub(crate) fn line_scanline(i: usize, h: usize) -> usize {
     let scanline = h / 2;
+    if h >= 3 {
+        let cycle_offset = (i % 3) as isize - 1;
+        (scanline as isize + cycle_offset).clamp(0, h as isize - 1) as usize
+    } else {
+        scanline
+    }
+}
+
+/// Build the line curve of a `w` x `h` image, resized from a line pattern
+/// `src_width` wide, from `weight(y, i)`, the normalized weight of column `i` in
+/// row `y`. Only rows returned by [`line_scanline`] are asked for.
+pub(crate) fn line_curve(
+    src_width: usize,
+    w: usize,
+    h: usize,
+    weight: impl Fn(usize, usize) -> f64,
+) -> FilterCurve {
+    let scale_factor = w as f64 / src_width as f64;
 
     let mut points = Vec::new();
     let mut tot = 0.0;
 
     for i in 0..w {
-        // Read from cycling scanlines (±1 row) as a consistency check,
-        // matching the C source behavior.
-        let y = if h >= 3 {
-            let cycle_offset = (i % 3) as isize - 1;
-            (scanline as isize + cycle_offset).clamp(0, h as isize - 1) as usize
-        } else {
-            scanline
-        };
-
-        let v = read_pixel(img, i, y, srgb);
-        let mut weight = (v - DARK as f64) / (BRIGHT as f64 - DARK as f64);
+        let mut weight = weight(line_scanline(i, h), i);
         tot += weight;
 
         let mut offset = 0.5 + i as f64 - (w as f64 / 2.0);
@@ -177,7 +521,7 @@ pub fn line_target() -> (usize, usize) {
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::pattern;
+    use crate::pattern::{self, DOT_HCENTER, DOT_NUM_STRIPS, DOT_SRC_WIDTH};
     use imgref::ImgVec;
 
     /// Nearest-neighbor resize for testing.
@@ -218,4 +562,76 @@ mod tests {
         // Area should be roughly 1.0 for a normalized filter
         assert!((curve.area - 1.0).abs() < 0.5, "area = {}", curve.area);
     }
+
+    #[test]
+    fn compact_curve_bins_scatter_and_keeps_lines() {
+        let dot = crate::perfect_resize(
+            pattern::dot_pattern(),
+            DOT_DST_WIDTH,
+            DOT_DST_HEIGHT,
+            crate::KnownFilter::Mitchell,
+        );
+        let curve = analyze_dot(&dot.as_ref(), false);
+        let compact = curve.compact();
+        assert!(compact.is_scatter);
+        assert_eq!(compact.bin_width(), crate::score::SCORE_BIN_WIDTH);
+        assert!(compact.offsets().windows(2).all(|p| p[0] < p[1]));
+        assert!(compact.heap_bytes() * 20 < curve.heap_bytes());
+        assert_eq!(compact.to_curve().points.len(), compact.len());
+
+        let line = pattern::generate_line_pattern();
+        let (tw, th) = line_target();
+        let line = analyze_line(&nn_resize(line.as_ref(), tw, th).as_ref(), false);
+        let compact = line.compact();
+        assert_eq!(compact.bin_width(), 0.0);
+        assert_eq!(compact.len(), line.points.len());
+        for ((x, w), &(rx, rw)) in compact.points().zip(&line.points) {
+            assert_eq!(x, rx as f32 as f64);
+            assert_eq!(w, rw as f32 as f64);
+        }
+    }
+
+    #[test]
+    fn racing_builds_share_one_table() {
+        let width = 3 * DOT_SRC_WIDTH + 1;
+        let tables: Vec<Arc<DotOffsetTable>> = std::thread::scope(|s| {
+            let handles: Vec<_> = (0..4)
+                .map(|_| s.spawn(move || dot_offset_table(width)))
+                .collect();
+            handles.into_iter().map(|h| h.join().unwrap()).collect()
+        });
+        assert!(tables.iter().all(|t| Arc::ptr_eq(t, &tables[0])));
+        assert_eq!(tables[0].width(), width);
+    }
+
+    #[test]
+    fn offset_table_is_cached_per_width() {
+        let a = dot_offset_table(DOT_DST_WIDTH);
+        let b = dot_offset_table(DOT_DST_WIDTH);
+        assert!(Arc::ptr_eq(&a, &b));
+        assert_eq!(a.width(), DOT_DST_WIDTH);
+
+        let wide = dot_offset_table(2 * DOT_SRC_WIDTH);
+        assert_eq!(wide.width(), 2 * DOT_SRC_WIDTH);
+        assert!(!wide.is_empty());
+        for strip in 0..DOT_NUM_STRIPS {
+            let entries = wide.strip(strip);
+            assert!(entries.windows(2).all(|p| p[0].0 < p[1].0));
+            assert!(
+                entries
+                    .iter()
+                    .all(|&(_, off)| off.abs() <= 2.0 * DOT_HCENTER as f64)
+            );
+        }
+    }
+
+    #[test]
+    fn weight_lut_anchors() {
+        for srgb in [false, true] {
+            let lut = weight_lut(srgb);
+            assert!(lut[DARK as usize].abs() < 1e-12, "srgb={srgb}");
+            assert!((lut[BRIGHT as usize] - 1.0).abs() < 1e-12, "srgb={srgb}");
+        }
+        assert_eq!(weight_lut(false)[150], 0.5);
+    }
 }
@@ -0,0 +1,136 @@
+//! Analysis with resizers that write into caller-owned output buffers.
+//!
+//! A [`ResizeIntoFn`](crate::ResizeIntoFn) receives the source pattern and a
+//! mutable view of the destination, already sized to the probe target, instead
+//! of returning a fresh image. The destination buffers live in a
+//! [`ProbeArena`] that is allocated once and reused by every analysis run
+//! against it.
+
+use imgref::ImgVec;
+
+use crate::analyze::{self, FilterCurve};
+use crate::edge::{self, EdgeMode};
+use crate::pixel::ProbePixel;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeIntoFnOf};
+
+/// Reusable output buffers for [`analyze_into`].
+///
+/// Holds one buffer for the dot probe and one shared by the line and edge
+/// probes (they have the same target size). The buffers are allocated by
+/// [`ProbeArena::new`] and never reallocated, so their addresses are stable for
+/// the life of the arena and can be registered or pinned by the resizer.
+///
+/// On entry to the callback a buffer holds whatever the previous probe wrote;
+/// the resizer must overwrite every pixel.
+#[derive(Debug, Clone)]
+pub struct ProbeArena<T = u8> {
+    dot: ImgVec<T>,
+    line: ImgVec<T>,
+}
+
+impl<T: ProbePixel> ProbeArena<T> {
+    /// Allocate the buffers at the dot and line probe target sizes.
+    pub fn new() -> Self {
+        let (dot_w, dot_h) = analyze::dot_target();
+        let (line_w, line_h) = analyze::line_target();
+        Self {
+            dot: ImgVec::new(vec![T::DARK; dot_w * dot_h], dot_w, dot_h),
+            line: ImgVec::new(vec![T::DARK; line_w * line_h], line_w, line_h),
+        }
+    }
+
+    /// The dot probe output from the most recent analysis.
+    pub fn dot(&self) -> &ImgVec<T> {
+        &self.dot
+    }
+
+    /// The line (or, with edge detection on, edge) probe output from the most
+    /// recent analysis. With a shorter [`LineProbe`](crate::LineProbe) only the
+    /// top rows are written.
+    pub fn line(&self) -> &ImgVec<T> {
+        &self.line
+    }
+
+    fn probe_dot(&mut self, resize: &ResizeIntoFnOf<T>, config: &AnalysisConfig) -> FilterCurve {
+        resize(T::patterns().dot.as_ref(), self.dot.as_mut());
+        analyze::analyze_dot(&self.dot.as_ref(), config.srgb)
+    }
+
+    fn probe_line(&mut self, resize: &ResizeIntoFnOf<T>, config: &AnalysisConfig) -> FilterCurve {
+        let probe = config.line_probe;
+        let (w, h) = probe.target();
+        resize(
+            probe.crop(T::patterns().line.as_ref()),
+            self.line.sub_image_mut(0, 0, w, h),
+        );
+        analyze::analyze_line(&self.line.sub_image(0, 0, w, h), config.srgb)
+    }
+
+    fn probe_edge(&mut self, resize: &ResizeIntoFnOf<T>, config: &AnalysisConfig) -> EdgeMode {
+        let probe = config.line_probe;
+        let (w, h) = probe.target();
+        resize(
+            probe.crop(T::patterns().edge.as_ref()),
+            self.line.sub_image_mut(0, 0, w, h),
+        );
+        edge::classify(self.line.sub_image(0, 0, w, h))
+    }
+}
+
+impl<T: ProbePixel> Default for ProbeArena<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// [`analyze`](fn@crate::analyze) with a resizer that writes into `arena`'s
+/// buffers instead of allocating its output.
+///
+/// Because the destination is always the expected size,
+/// [`Error::WrongDimensions`] cannot occur; [`Error::NoData`] still can.
+pub fn analyze_into<T: ProbePixel>(
+    resize: &ResizeIntoFnOf<T>,
+    config: &AnalysisConfig,
+    arena: &mut ProbeArena<T>,
+) -> Result<AnalysisResult, Error> {
+    let downscale_curve = arena.probe_dot(resize, config);
+    let upscale_curve = arena.probe_line(resize, config);
+    let edge_mode = config
+        .detect_edges
+        .then(|| arena.probe_edge(resize, config));
+    crate::assemble_result(downscale_curve, upscale_curve, edge_mode)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::KnownFilter;
+    use crate::test_util::lanczos3;
+    use imgref::{ImgRef, ImgRefMut};
+
+    fn lanczos3_into(src: ImgRef<'_, u8>, mut dst: ImgRefMut<'_, u8>) {
+        let out = crate::perfect_resize(src, dst.width(), dst.height(), KnownFilter::Lanczos3);
+        for (d, s) in dst.rows_mut().zip(out.rows()) {
+            d.copy_from_slice(s);
+        }
+    }
+
+    #[test]
+    fn matches_allocating_analyze() {
+        let config = AnalysisConfig::default();
+        let mut arena = ProbeArena::new();
+        let dot_ptr = arena.dot().buf().as_ptr();
+
+        let into = analyze_into(&lanczos3_into, &config, &mut arena).unwrap();
+        let again = analyze_into(&lanczos3_into, &config, &mut arena).unwrap();
+        assert_eq!(arena.dot().buf().as_ptr(), dot_ptr);
+
+        let alloc = crate::analyze(&lanczos3, &config).unwrap();
+
+        for result in [&into, &again] {
+            assert_eq!(result.scores[0].filter, alloc.scores[0].filter);
+            assert_eq!(result.scores[0].correlation, alloc.scores[0].correlation);
+            assert_eq!(result.edge_mode, alloc.edge_mode);
+        }
+    }
+}
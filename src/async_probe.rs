@@ -0,0 +1,238 @@
+//! Analysis with asynchronous resize callbacks.
+//!
+//! A remote service or GPU queue answers a resize some time after it is asked.
+//! [`analyze_async`] takes an [`AsyncResizeFn`] that returns a future per
+//! resize, submits the dot, line and edge probes at once, and analyzes each
+//! response as it arrives, so one configuration costs one round trip instead
+//! of three.
+//!
+//! Only `std` future machinery is used: the returned future runs on any
+//! executor.
+
+use std::future::{Future, poll_fn};
+use std::pin::Pin;
+use std::task::Poll;
+
+use imgref::{ImgRef, ImgVec};
+
+use crate::analyze::{self, FilterCurve};
+use crate::edge::{self, EdgeMode};
+use crate::pattern;
+use crate::{AnalysisConfig, AnalysisResult, Error};
+
+/// The future an [`AsyncResizeFn`] returns: the resized image.
+pub type ResizeFuture = Pin<Box<dyn Future<Output = ImgVec<u8>> + Send>>;
+
+/// An asynchronous [`ResizeFn`](crate::ResizeFn). The source is one of the
+/// crate's static probe patterns, so the future may hold on to it.
+pub type AsyncResizeFn = dyn Fn(ImgRef<'static, u8>, usize, usize) -> ResizeFuture + Send + Sync;
+
+/// One submitted probe and what to do with its response.
+struct Pending {
+    future: Option<ResizeFuture>,
+    target: (usize, usize),
+}
+
+impl Pending {
+    fn submit(resize: &AsyncResizeFn, src: ImgRef<'static, u8>, target: (usize, usize)) -> Self {
+        Self {
+            future: Some(resize(src, target.0, target.1)),
+            target,
+        }
+    }
+}
+
+/// [`analyze`](fn@crate::analyze) with an asynchronous resizer.
+///
+/// All probes are submitted before the first is awaited, and each response
+/// is checked and analyzed as soon as it arrives. The result is the same as
+/// `analyze` with a synchronous resizer returning the same images. A response
+/// of the wrong size fails the analysis at once and drops the probes still
+/// in flight.
+pub async fn analyze_async(
+    resize: &AsyncResizeFn,
+    config: &AnalysisConfig,
+) -> Result<AnalysisResult, Error> {
+    let patterns = pattern::patterns();
+    let line_target = config.line_probe.target();
+    let mut dot = Pending::submit(resize, patterns.dot.as_ref(), analyze::dot_target());
+    let mut line = Pending::submit(
+        resize,
+        config.line_probe.crop(patterns.line.as_ref()),
+        line_target,
+    );
+    let mut edge = config.detect_edges.then(|| {
+        Pending::submit(
+            resize,
+            config.line_probe.crop(patterns.edge.as_ref()),
+            line_target,
+        )
+    });
+
+    let mut downscale_curve: Option<FilterCurve> = None;
+    let mut upscale_curve: Option<FilterCurve> = None;
+    let mut edge_mode: Option<EdgeMode> = None;
+
+    poll_fn(|cx| {
+        if let Some(img) = poll_probe(&mut dot, cx) {
+            crate::check_dimensions(&img, dot.target.0, dot.target.1)?;
+            downscale_curve = Some(analyze::analyze_dot(&img.as_ref(), config.srgb));
+        }
+        if let Some(img) = poll_probe(&mut line, cx) {
+            crate::check_dimensions(&img, line.target.0, line.target.1)?;
+            upscale_curve = Some(analyze::analyze_line(&img.as_ref(), config.srgb));
+        }
+        if let Some(edge) = edge.as_mut()
+            && let Some(img) = poll_probe(edge, cx)
+        {
+            // As in edge::detect, a wrong-sized edge response is not an error.
+            edge_mode = Some(if (img.width(), img.height()) == edge.target {
+                edge::classify(img.as_ref())
+            } else {
+                EdgeMode::Unknown
+            });
+        }
+
+        let edge_done = edge.as_ref().is_none_or(|e| e.future.is_none());
+        if dot.future.is_none() && line.future.is_none() && edge_done {
+            Poll::Ready(Ok(()))
+        } else {
+            Poll::Pending
+        }
+    })
+    .await?;
+
+    crate::assemble_result(
+        downscale_curve.expect("dot probe finished"),
+        upscale_curve.expect("line probe finished"),
+        edge_mode,
+    )
+}
+
+/// Poll a probe still in flight, returning its image the one time it is ready.
+fn poll_probe(probe: &mut Pending, cx: &mut std::task::Context<'_>) -> Option<ImgVec<u8>> {
+    let future = probe.future.as_mut()?;
+    match future.as_mut().poll(cx) {
+        Poll::Ready(img) => {
+            probe.future = None;
+            Some(img)
+        }
+        Poll::Pending => None,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::test_util::lanczos3;
+    use crate::{KnownFilter, perfect_resize};
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::sync::{Arc, Mutex};
+    use std::task::{Context, Wake, Waker};
+
+    /// Minimal executor: poll on the current thread, parking between wakes.
+    fn block_on<F: Future>(future: F) -> F::Output {
+        struct Unpark(std::thread::Thread);
+        impl Wake for Unpark {
+            fn wake(self: Arc<Self>) {
+                self.0.unpark();
+            }
+        }
+        let waker = Waker::from(Arc::new(Unpark(std::thread::current())));
+        let mut cx = Context::from_waker(&waker);
+        let mut future = std::pin::pin!(future);
+        loop {
+            if let Poll::Ready(out) = future.as_mut().poll(&mut cx) {
+                return out;
+            }
+            std::thread::park();
+        }
+    }
+
+    /// The Lanczos3 result, delivered after `polls` pending polls. Records
+    /// how many resizes are in flight at once into `stats`.
+    struct Delayed {
+        polls: usize,
+        out: Option<ImgVec<u8>>,
+        started: bool,
+        stats: Arc<Mutex<Stats>>,
+    }
+
+    #[derive(Default)]
+    struct Stats {
+        in_flight: usize,
+        max_in_flight: usize,
+        order: Vec<usize>,
+    }
+
+    impl Future for Delayed {
+        type Output = ImgVec<u8>;
+
+        fn poll(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<ImgVec<u8>> {
+            let this = &mut *self;
+            let mut stats = this.stats.lock().unwrap();
+            if !this.started {
+                this.started = true;
+                stats.in_flight += 1;
+                stats.max_in_flight = stats.max_in_flight.max(stats.in_flight);
+            }
+            if this.polls == 0 {
+                stats.in_flight -= 1;
+                let out = this.out.take().expect("polled after completion");
+                stats.order.push(out.width() * out.height());
+                return Poll::Ready(out);
+            }
+            this.polls -= 1;
+            cx.waker().wake_by_ref();
+            Poll::Pending
+        }
+    }
+
+    fn remote(
+        stats: Arc<Mutex<Stats>>,
+    ) -> impl Fn(ImgRef<'static, u8>, usize, usize) -> ResizeFuture {
+        move |src, w, h| {
+            // The 15-row edge and line probes take longer than the dot probe,
+            // and the line probe longest of all.
+            static CALL: AtomicUsize = AtomicUsize::new(0);
+            let polls = [2, 6, 4][CALL.fetch_add(1, Ordering::Relaxed) % 3];
+            Box::pin(Delayed {
+                polls,
+                out: Some(perfect_resize(src, w, h, KnownFilter::Lanczos3)),
+                started: false,
+                stats: Arc::clone(&stats),
+            })
+        }
+    }
+
+    #[test]
+    fn probes_run_concurrently_and_match_sync() {
+        let stats = Arc::new(Mutex::new(Stats::default()));
+        let resize = remote(Arc::clone(&stats));
+        let config = AnalysisConfig::default();
+        let future = analyze_async(&resize, &config);
+        fn assert_send<T: Send>(_: &T) {}
+        assert_send(&future);
+        let result = block_on(future).unwrap();
+
+        let sync = crate::analyze(&lanczos3, &config).unwrap();
+        assert_eq!(result.scores[0].filter, sync.scores[0].filter);
+        assert_eq!(result.scores[0].correlation, sync.scores[0].correlation);
+        assert_eq!(result.edge_mode, sync.edge_mode);
+
+        let stats = stats.lock().unwrap();
+        assert_eq!(stats.max_in_flight, 3);
+        assert_eq!(stats.in_flight, 0);
+        // The dot probe, quickest to answer, was analyzed first.
+        assert_eq!(stats.order, [555 * 275, 555 * 15, 555 * 15]);
+    }
+
+    #[test]
+    fn wrong_size_fails_without_waiting_for_the_rest() {
+        fn wrong(_: ImgRef<'static, u8>, _: usize, _: usize) -> ResizeFuture {
+            Box::pin(std::future::ready(ImgVec::new(vec![0; 4], 2, 2)))
+        }
+        let err = block_on(analyze_async(&wrong, &AnalysisConfig::default())).unwrap_err();
+        assert!(matches!(err, Error::WrongDimensions { .. }));
+    }
+}
@@ -0,0 +1,160 @@
+//! Analyze many resizer configurations at once on a bounded worker pool.
+//!
+//! Every job contributes up to three independent probes (dot, line, and edge
+//! detection). All probes of all jobs are fanned out across the pool, and the
+//! per-job results are assembled and scored once their probes are done.
+
+use crate::analyze::FilterCurve;
+use crate::edge::{self, EdgeMode};
+use crate::{AnalysisConfig, AnalysisResult, Error, SyncResizeFn, parallel};
+
+/// One resizer configuration to analyze in a batch.
+#[derive(Clone)]
+pub struct BatchJob<'a> {
+    /// Caller-chosen name, carried through to the [`BatchOutcome`].
+    pub label: &'a str,
+    /// The resizer under test. Shared across worker threads.
+    pub resize: &'a SyncResizeFn,
+    /// Analysis settings for this job.
+    pub config: AnalysisConfig,
+}
+
+/// The result of one [`BatchJob`].
+#[derive(Debug)]
+pub struct BatchOutcome<'a> {
+    /// The label of the job this outcome belongs to.
+    pub label: &'a str,
+    /// The same result [`analyze`](fn@crate::analyze) would have returned for the job.
+    pub result: Result<AnalysisResult, Error>,
+}
+
+#[derive(Clone, Copy)]
+enum Probe {
+    Dot,
+    Line,
+    Edge,
+}
+
+enum ProbeOutput {
+    Curve(Result<FilterCurve, Error>),
+    Edge(EdgeMode),
+}
+
+/// Run [`analyze`](fn@crate::analyze) for every job, spreading the probes over
+/// up to `max_threads` worker threads (`None` uses the available parallelism).
+///
+/// Outcomes come back in the same order as `jobs`, each carrying that job's own
+/// error if it failed. Unlike a serial `analyze`, edge detection for a job is
+/// not skipped when one of its other probes fails; its result is discarded.
+pub fn analyze_batch<'a>(
+    jobs: &[BatchJob<'a>],
+    max_threads: Option<usize>,
+) -> Vec<BatchOutcome<'a>> {
+    let tasks: Vec<(usize, Probe)> = jobs
+        .iter()
+        .enumerate()
+        .flat_map(|(i, job)| {
+            let edge = job.config.detect_edges.then_some((i, Probe::Edge));
+            [Some((i, Probe::Dot)), Some((i, Probe::Line)), edge]
+        })
+        .flatten()
+        .collect();
+
+    let threads = parallel::worker_count(max_threads, tasks.len());
+    let mut outputs = parallel::map_indexed(tasks.len(), threads, |t| {
+        let (i, probe) = tasks[t];
+        let job = &jobs[i];
+        match probe {
+            Probe::Dot => ProbeOutput::Curve(crate::probe_dot::<u8>(job.resize, &job.config)),
+            Probe::Line => ProbeOutput::Curve(crate::probe_line::<u8>(job.resize, &job.config)),
+            Probe::Edge => ProbeOutput::Edge(edge::detect_with(job.resize, job.config.line_probe)),
+        }
+    })
+    .into_iter();
+
+    // Tasks were queued job by job, so each job's outputs are contiguous.
+    jobs.iter()
+        .map(|job| {
+            let dot = outputs.next();
+            let line = outputs.next();
+            let edge_mode = if job.config.detect_edges {
+                match outputs.next() {
+                    Some(ProbeOutput::Edge(mode)) => Some(mode),
+                    _ => unreachable!("edge probe output out of order"),
+                }
+            } else {
+                None
+            };
+
+            let result = match (dot, line) {
+                (Some(ProbeOutput::Curve(dot)), Some(ProbeOutput::Curve(line))) => dot
+                    .and_then(|dot| line.map(|line| (dot, line)))
+                    .and_then(|(dot, line)| crate::assemble_result(dot, line, edge_mode)),
+                _ => unreachable!("curve probe output out of order"),
+            };
+
+            BatchOutcome {
+                label: job.label,
+                result,
+            }
+        })
+        .collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::KnownFilter;
+    use crate::test_util::lanczos3;
+    use imgref::{ImgRef, ImgVec};
+
+    fn triangle(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        crate::perfect_resize(src, w, h, KnownFilter::Triangle)
+    }
+
+    fn wrong_size(_src: ImgRef<'_, u8>, _w: usize, _h: usize) -> ImgVec<u8> {
+        ImgVec::new(vec![0u8; 4], 2, 2)
+    }
+
+    #[test]
+    fn batch_matches_serial_in_order() {
+        let config = AnalysisConfig::default();
+        let jobs = [
+            BatchJob {
+                label: "lanczos3",
+                resize: &lanczos3,
+                config: config.clone(),
+            },
+            BatchJob {
+                label: "broken",
+                resize: &wrong_size,
+                config: config.clone(),
+            },
+            BatchJob {
+                label: "triangle",
+                resize: &triangle,
+                config: config.clone(),
+            },
+        ];
+
+        let outcomes = analyze_batch(&jobs, Some(4));
+        assert_eq!(outcomes.len(), 3);
+        assert_eq!(outcomes[0].label, "lanczos3");
+        assert_eq!(outcomes[1].label, "broken");
+        assert_eq!(outcomes[2].label, "triangle");
+
+        let serial = crate::analyze(&lanczos3, &config).unwrap();
+        let batched = outcomes[0].result.as_ref().unwrap();
+        assert_eq!(batched.scores[0].filter, serial.scores[0].filter);
+        assert_eq!(batched.scores[0].correlation, serial.scores[0].correlation);
+        assert_eq!(batched.edge_mode, serial.edge_mode);
+
+        assert!(matches!(
+            outcomes[1].result,
+            Err(Error::WrongDimensions { .. })
+        ));
+
+        let best = &outcomes[2].result.as_ref().unwrap().scores[0];
+        assert_eq!(best.filter, KnownFilter::Triangle);
+    }
+}
@@ -0,0 +1,388 @@
+//! Throughput measurement of a resizer, reported next to its analysis.
+//!
+//! [`benchmark`] times the same callback [`analyze`](fn@crate::analyze) takes
+//! over a list of [`BenchCase`]s: the probe patterns themselves plus a few
+//! photo-sized resizes. [`bench_report`] runs both and produces a
+//! [`BenchReport`] whose `Display` leads with a one-line summary such as
+//! `lanczos3: Lanczos3 (r=0.9998) at 3.21 ns/px`.
+//!
+//! This is a smoke benchmark for CI dashboards, not a substitute for a full
+//! statistical harness: every case runs a fixed number of samples after a
+//! warmup, timed with [`Instant`].
+
+use std::fmt;
+use std::time::Instant;
+
+use imgref::ImgVec;
+
+use crate::pattern;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFn};
+
+/// Where a [`BenchCase`] gets its source image from.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum BenchSource {
+    /// The dot probe pattern (557x275).
+    DotPattern,
+    /// The line probe pattern (15x15).
+    LinePattern,
+    /// A deterministic synthetic photo (gradients plus noise) of this size.
+    Synthetic { width: usize, height: usize },
+}
+
+/// One timed resize: a source image and the size to resize it to.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct BenchCase {
+    /// Short name used in the report.
+    pub label: &'static str,
+    /// The image to resize.
+    pub source: BenchSource,
+    /// Width to resize it to.
+    pub dst_width: usize,
+    /// Height to resize it to.
+    pub dst_height: usize,
+}
+
+impl BenchCase {
+    /// The dot probe at its analysis target size.
+    pub const DOT_PROBE: Self = Self {
+        label: "dot probe",
+        source: BenchSource::DotPattern,
+        dst_width: pattern::DOT_DST_WIDTH,
+        dst_height: pattern::DOT_DST_HEIGHT,
+    };
+
+    /// The line probe at its analysis target size.
+    pub const LINE_PROBE: Self = Self {
+        label: "line probe",
+        source: BenchSource::LinePattern,
+        dst_width: pattern::LINE_DST_WIDTH,
+        dst_height: pattern::LINE_DST_HEIGHT,
+    };
+
+    /// The probes plus a 1080p downscale to a third, a 1024px square
+    /// thumbnail, and a 3x upscale of 640x480.
+    pub fn standard() -> Vec<Self> {
+        let synthetic = |label, (width, height), (dst_width, dst_height)| Self {
+            label,
+            source: BenchSource::Synthetic { width, height },
+            dst_width,
+            dst_height,
+        };
+        vec![
+            Self::DOT_PROBE,
+            Self::LINE_PROBE,
+            synthetic("1080p to 1/3", (1920, 1080), (640, 360)),
+            synthetic("thumbnail", (1024, 1024), (256, 256)),
+            synthetic("3x upscale", (640, 480), (1920, 1440)),
+        ]
+    }
+
+    /// Output pixels per resize.
+    pub fn pixels(&self) -> usize {
+        self.dst_width * self.dst_height
+    }
+
+    fn source_image(&self) -> ImgVec<u8> {
+        match self.source {
+            BenchSource::DotPattern => pattern::patterns().dot.clone(),
+            BenchSource::LinePattern => pattern::patterns().line.clone(),
+            BenchSource::Synthetic { width, height } => synthetic_photo(width, height),
+        }
+    }
+}
+
+/// Settings for [`benchmark`].
+#[derive(Debug, Clone)]
+pub struct BenchConfig {
+    /// The resizes to time, in report order.
+    pub cases: Vec<BenchCase>,
+    /// Untimed runs per case before sampling.
+    pub warmup: usize,
+    /// Timed runs per case. At least one is always taken.
+    pub samples: usize,
+    /// Running total of heap allocations, if the caller has one (typically a
+    /// counting `#[global_allocator]`). When set, every [`CaseTiming`] reports
+    /// the allocations per resize.
+    pub allocation_counter: Option<fn() -> u64>,
+}
+
+impl Default for BenchConfig {
+    fn default() -> Self {
+        Self {
+            cases: BenchCase::standard(),
+            warmup: 1,
+            samples: 5,
+            allocation_counter: None,
+        }
+    }
+}
+
+/// Timing of one [`BenchCase`].
+#[derive(Debug, Clone, PartialEq)]
+pub struct CaseTiming {
+    /// The case that was timed.
+    pub case: BenchCase,
+    /// Number of timed runs.
+    pub samples: usize,
+    /// Mean time per output pixel, in nanoseconds.
+    pub mean_ns_per_px: f64,
+    /// Sample variance of the per-run time per output pixel, in ns².
+    pub variance: f64,
+    /// Fastest run, in nanoseconds per output pixel.
+    pub min_ns_per_px: f64,
+    /// Size of the image returned by one resize.
+    pub output_bytes: usize,
+    /// Mean heap allocations per resize, if an allocation counter was given.
+    pub allocations: Option<f64>,
+}
+
+impl CaseTiming {
+    /// Standard deviation of the time per output pixel, in nanoseconds.
+    pub fn stddev(&self) -> f64 {
+        self.variance.sqrt()
+    }
+}
+
+impl fmt::Display for CaseTiming {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let (sw, sh) = match self.case.source {
+            BenchSource::DotPattern => (pattern::DOT_SRC_WIDTH, pattern::DOT_SRC_HEIGHT),
+            BenchSource::LinePattern => (pattern::LINE_SRC_WIDTH, pattern::LINE_SRC_HEIGHT),
+            BenchSource::Synthetic { width, height } => (width, height),
+        };
+        write!(
+            f,
+            "{} ({sw}x{sh} -> {}x{}): {:.2} ± {:.2} ns/px (min {:.2}), {} B out",
+            self.case.label,
+            self.case.dst_width,
+            self.case.dst_height,
+            self.mean_ns_per_px,
+            self.stddev(),
+            self.min_ns_per_px,
+            self.output_bytes
+        )?;
+        if let Some(allocs) = self.allocations {
+            write!(f, ", {allocs:.1} allocs")?;
+        }
+        Ok(())
+    }
+}
+
+/// Time `resize` on every case of `config`, in order.
+///
+/// Source images are built before timing starts. Fails with
+/// [`Error::WrongDimensions`] if the resizer returns the wrong size for a case.
+pub fn benchmark(resize: &ResizeFn, config: &BenchConfig) -> Result<Vec<CaseTiming>, Error> {
+    config
+        .cases
+        .iter()
+        .map(|case| time_case(resize, case, config))
+        .collect()
+}
+
+fn time_case(
+    resize: &ResizeFn,
+    case: &BenchCase,
+    config: &BenchConfig,
+) -> Result<CaseTiming, Error> {
+    let src = case.source_image();
+    let (w, h) = (case.dst_width, case.dst_height);
+    let out = resize(src.as_ref(), w, h);
+    crate::check_dimensions(&out, w, h)?;
+    let output_bytes = std::mem::size_of_val(out.buf().as_slice());
+    drop(out);
+    for _ in 0..config.warmup {
+        drop(resize(src.as_ref(), w, h));
+    }
+
+    let samples = config.samples.max(1);
+    let pixels = case.pixels().max(1) as f64;
+    let allocs_before = config.allocation_counter.map(|count| count());
+    let mut per_px = Vec::with_capacity(samples);
+    for _ in 0..samples {
+        let start = Instant::now();
+        let out = resize(src.as_ref(), w, h);
+        let elapsed = start.elapsed();
+        drop(out);
+        per_px.push(elapsed.as_nanos() as f64 / pixels);
+    }
+    let allocations = config
+        .allocation_counter
+        .zip(allocs_before)
+        .map(|(count, before)| count().saturating_sub(before) as f64 / samples as f64);
+
+    let mean = per_px.iter().sum::<f64>() / samples as f64;
+    let variance = if samples > 1 {
+        per_px.iter().map(|t| (t - mean).powi(2)).sum::<f64>() / (samples - 1) as f64
+    } else {
+        0.0
+    };
+    Ok(CaseTiming {
+        case: *case,
+        samples,
+        mean_ns_per_px: mean,
+        variance,
+        min_ns_per_px: per_px.iter().copied().fold(f64::INFINITY, f64::min),
+        output_bytes,
+        allocations,
+    })
+}
+
+/// Analysis and throughput of one resizer. See [`bench_report`].
+#[derive(Debug, Clone)]
+pub struct BenchReport<'a> {
+    /// Caller-chosen name of the resizer.
+    pub label: &'a str,
+    /// The resizer's [`analyze`](fn@crate::analyze) result.
+    pub analysis: AnalysisResult,
+    /// Timing of every benchmark case, in [`BenchConfig::cases`] order.
+    pub timings: Vec<CaseTiming>,
+}
+
+impl BenchReport<'_> {
+    /// Overall time per output pixel: total time over total pixels, with each
+    /// case weighted by its mean.
+    pub fn ns_per_pixel(&self) -> f64 {
+        let (ns, px) = self.timings.iter().fold((0.0, 0.0), |(ns, px), t| {
+            let pixels = t.case.pixels() as f64;
+            (ns + t.mean_ns_per_px * pixels, px + pixels)
+        });
+        if px > 0.0 { ns / px } else { 0.0 }
+    }
+}
+
+impl fmt::Display for BenchReport<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "{}: ", self.label)?;
+        match (self.analysis.best_match(), self.analysis.scores.first()) {
+            (Some(best), _) => write!(f, "{} (r={:.4})", best.filter, best.correlation)?,
+            (None, Some(top)) => write!(
+                f,
+                "no confident match (closest {}, r={:.4})",
+                top.filter, top.correlation
+            )?,
+            (None, None) => f.write_str("no match")?,
+        }
+        writeln!(f, " at {:.2} ns/px", self.ns_per_pixel())?;
+        for score in self.analysis.scores.iter().take(3) {
+            writeln!(f, "  {score}")?;
+        }
+        for timing in &self.timings {
+            writeln!(f, "  {timing}")?;
+        }
+        Ok(())
+    }
+}
+
+/// [`analyze`](fn@crate::analyze) and [`benchmark`] one resizer.
+pub fn bench_report<'a>(
+    label: &'a str,
+    resize: &ResizeFn,
+    analysis: &AnalysisConfig,
+    bench: &BenchConfig,
+) -> Result<BenchReport<'a>, Error> {
+    Ok(BenchReport {
+        label,
+        analysis: crate::analyze(resize, analysis)?,
+        timings: benchmark(resize, bench)?,
+    })
+}
+
+/// A `width` x `height` test image: two crossed gradients plus xorshift noise,
+/// so the resizer sees both smooth areas and detail.
+fn synthetic_photo(width: usize, height: usize) -> ImgVec<u8> {
+    let mut state = 0x9e37_79b9_u32;
+    let mut pixels = Vec::with_capacity(width * height);
+    for y in 0..height {
+        for x in 0..width {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            let gradient = (x * 160 / width.max(1) + y * 64 / height.max(1)) as u32;
+            pixels.push((gradient + (state & 31)) as u8);
+        }
+    }
+    ImgVec::new(pixels, width, height)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::test_util::{counted, lanczos3};
+    use crate::{KnownFilter, perfect_resize};
+    use imgref::ImgRef;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    fn small_config() -> BenchConfig {
+        BenchConfig {
+            cases: vec![
+                BenchCase::LINE_PROBE,
+                BenchCase {
+                    label: "tiny",
+                    source: BenchSource::Synthetic {
+                        width: 64,
+                        height: 48,
+                    },
+                    dst_width: 20,
+                    dst_height: 15,
+                },
+            ],
+            warmup: 1,
+            samples: 3,
+            allocation_counter: None,
+        }
+    }
+
+    #[test]
+    fn report_pairs_score_with_throughput() {
+        // `allocation_counter` is a plain `fn`, so this test's counter is a
+        // static of its own.
+        static CALLS: AtomicU64 = AtomicU64::new(0);
+        fn calls() -> u64 {
+            CALLS.load(Ordering::Relaxed)
+        }
+        let config = BenchConfig {
+            allocation_counter: Some(calls),
+            ..small_config()
+        };
+        let report = bench_report(
+            "lanczos3",
+            &counted(&CALLS, lanczos3),
+            &AnalysisConfig::default(),
+            &config,
+        )
+        .unwrap();
+        assert_eq!(report.timings.len(), 2);
+        for t in &report.timings {
+            assert_eq!(t.samples, 3);
+            assert!(t.mean_ns_per_px >= t.min_ns_per_px);
+            assert!(t.variance >= 0.0);
+            assert_eq!(t.output_bytes, t.case.pixels());
+            // The counter is bumped once per call, standing in for an allocator.
+            assert_eq!(t.allocations, Some(1.0));
+        }
+        assert!(report.ns_per_pixel() > 0.0);
+        let text = report.to_string();
+        assert!(text.starts_with("lanczos3: Lanczos3 (r="), "{text}");
+        assert!(text.contains("ns/px"), "{text}");
+    }
+
+    #[test]
+    fn wrong_size_is_an_error() {
+        let half = |src: ImgRef<'_, u8>, w: usize, h: usize| {
+            perfect_resize(src, w / 2, h, KnownFilter::Box)
+        };
+        assert!(matches!(
+            benchmark(&half, &small_config()),
+            Err(Error::WrongDimensions { .. })
+        ));
+    }
+
+    #[test]
+    fn synthetic_source_is_deterministic() {
+        let a = synthetic_photo(33, 7);
+        let b = synthetic_photo(33, 7);
+        assert_eq!(a.buf(), b.buf());
+        assert_eq!(a.width(), 33);
+    }
+}
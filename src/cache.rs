@@ -0,0 +1,639 @@
+//! Caching analysis results across runs, keyed by a resizer fingerprint.
+//!
+//! An [`AnalysisCache`] maps a caller-chosen configuration ID to the last
+//! [`AnalysisResult`] computed for it and a [`fingerprint`] of the resizer's
+//! line probe output. [`AnalysisCache::analyze`] always runs the line probe
+//! (one small resize), and when the fingerprint still matches it returns the
+//! stored result without running the dot and edge probes or scoring.
+//!
+//! The crate does no I/O: [`AnalysisCache::to_bytes`] and
+//! [`AnalysisCache::from_bytes`] convert to and from a little-endian binary
+//! format that the caller stores wherever it likes. Inside it, the points of
+//! every curve are a contiguous run of `(offset, weight)` `f64` pairs starting
+//! at a multiple of 8 bytes from the start of the buffer, so a memory-mapped
+//! file can be read in place. [`encode_result`] and [`decode_result`] expose
+//! the same layout for a single result.
+//!
+//! # Layout
+//!
+//! All integers and floats are little-endian. `pad8` is zero bytes up to the
+//! next multiple of 8 from the start of the buffer.
+//!
+//! ```text
+//! cache:  b"RSCACHE\0"  u32 version  u32 entry_count  entry*
+//! entry:  u32 id_len  id (UTF-8)  pad8  u64 fingerprint  result
+//! result: u8 edge_mode (0xFF = none)  u8 curve_flags  pad8
+//!         [curve if flags & 1]  [curve if flags & 2]
+//!         u32 score_count  pad8  score*
+//! curve:  u32 point_count  u8 is_scatter  pad8  f64 area  f64 scale_factor
+//!         (f64 offset, f64 weight)*
+//! score:  u8 filter  pad8  f64 param0  f64 param1
+//!         f64 correlation  f64 rms_error  f64 max_error
+//!         f64 detected_support  f64 expected_support
+//! ```
+
+use std::collections::BTreeMap;
+
+use imgref::ImgRef;
+
+use crate::analyze::{self, FilterCurve};
+use crate::edge::{self, EdgeMode};
+use crate::filters::KnownFilter;
+use crate::score::FilterScore;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFn};
+
+const MAGIC: &[u8; 8] = b"RSCACHE\0";
+
+/// Version of the binary layout written by [`AnalysisCache::to_bytes`].
+pub const FORMAT_VERSION: u32 = 1;
+
+const NO_EDGE_MODE: u8 = 0xFF;
+
+/// The stored result for one configuration ID.
+#[derive(Debug, Clone)]
+pub struct CacheEntry {
+    /// [`fingerprint`] of the line probe output the result was computed from.
+    pub fingerprint: u64,
+    /// The full analysis.
+    pub result: AnalysisResult,
+}
+
+/// The outcome of [`AnalysisCache::analyze`].
+#[derive(Debug, Clone)]
+pub struct CachedAnalysis {
+    /// The analysis, fresh or from the cache.
+    pub result: AnalysisResult,
+    /// True if the fingerprint matched and the stored result was returned.
+    pub hit: bool,
+}
+
+/// Analysis results keyed by configuration ID. See the [module docs](self).
+#[derive(Debug, Clone, Default)]
+pub struct AnalysisCache {
+    entries: BTreeMap<String, CacheEntry>,
+}
+
+impl AnalysisCache {
+    /// An empty cache.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Number of stored configurations.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// True if nothing is stored.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// The stored entry for `id`, if any.
+    pub fn get(&self, id: &str) -> Option<&CacheEntry> {
+        self.entries.get(id)
+    }
+
+    /// Store `entry` under `id`, returning the entry it replaces.
+    pub fn insert(&mut self, id: impl Into<String>, entry: CacheEntry) -> Option<CacheEntry> {
+        self.entries.insert(id.into(), entry)
+    }
+
+    /// Remove and return the entry for `id`.
+    pub fn remove(&mut self, id: &str) -> Option<CacheEntry> {
+        self.entries.remove(id)
+    }
+
+    /// Stored `(id, entry)` pairs, sorted by ID.
+    pub fn iter(&self) -> impl Iterator<Item = (&str, &CacheEntry)> {
+        self.entries.iter().map(|(id, e)| (id.as_str(), e))
+    }
+
+    /// [`analyze`](fn@crate::analyze) `resize`, reusing the result stored
+    /// under `id` if the resizer's line probe output (and `config`) is
+    /// unchanged.
+    ///
+    /// On a miss the line probe output is reused rather than resized again, so
+    /// a miss costs the same number of calls as an uncached analysis and a hit
+    /// costs one.
+    pub fn analyze(
+        &mut self,
+        id: &str,
+        resize: &ResizeFn,
+        config: &AnalysisConfig,
+    ) -> Result<CachedAnalysis, Error> {
+        let (line_w, line_h) = config.line_probe.target();
+        let line = resize(
+            config.line_probe.crop(crate::pattern::line_pattern()),
+            line_w,
+            line_h,
+        );
+        crate::check_dimensions(&line, line_w, line_h)?;
+        let print = fingerprint(line.as_ref(), config);
+
+        if let Some(entry) = self.entries.get(id).filter(|e| e.fingerprint == print) {
+            return Ok(CachedAnalysis {
+                result: entry.result.clone(),
+                hit: true,
+            });
+        }
+
+        let downscale_curve = crate::probe_dot(resize, config)?;
+        let upscale_curve = analyze::analyze_line(&line.as_ref(), config.srgb);
+        let edge_mode = config
+            .detect_edges
+            .then(|| edge::detect_with(resize, config.line_probe));
+        let result = crate::assemble_result(downscale_curve, upscale_curve, edge_mode)?;
+        self.entries.insert(
+            id.to_owned(),
+            CacheEntry {
+                fingerprint: print,
+                result: result.clone(),
+            },
+        );
+        Ok(CachedAnalysis { result, hit: false })
+    }
+
+    /// Serialize every entry in the binary layout of the [module docs](self).
+    pub fn to_bytes(&self) -> Vec<u8> {
+        let mut w = Writer(Vec::new());
+        w.0.extend_from_slice(MAGIC);
+        w.u32(FORMAT_VERSION);
+        w.u32(self.entries.len() as u32);
+        for (id, entry) in &self.entries {
+            w.u32(id.len() as u32);
+            w.0.extend_from_slice(id.as_bytes());
+            w.pad8();
+            w.u64(entry.fingerprint);
+            write_result(&mut w, &entry.result);
+        }
+        w.0
+    }
+
+    /// Parse bytes written by [`to_bytes`](Self::to_bytes).
+    ///
+    /// Returns [`Error::CorruptCache`] on any truncation, unknown version or
+    /// out-of-range field.
+    pub fn from_bytes(bytes: &[u8]) -> Result<Self, Error> {
+        let mut r = Reader { bytes, pos: 0 };
+        if r.take(MAGIC.len())? != MAGIC {
+            return Err(Error::CorruptCache("bad magic"));
+        }
+        if r.u32()? != FORMAT_VERSION {
+            return Err(Error::CorruptCache("unsupported format version"));
+        }
+        let count = r.u32()?;
+        let mut entries = BTreeMap::new();
+        for _ in 0..count {
+            let id_len = r.u32()? as usize;
+            let id = std::str::from_utf8(r.take(id_len)?)
+                .map_err(|_| Error::CorruptCache("ID is not UTF-8"))?
+                .to_owned();
+            r.pad8()?;
+            let fingerprint = r.u64()?;
+            let result = read_result(&mut r)?;
+            entries.insert(
+                id,
+                CacheEntry {
+                    fingerprint,
+                    result,
+                },
+            );
+        }
+        if r.pos != bytes.len() {
+            return Err(Error::CorruptCache("trailing bytes"));
+        }
+        Ok(Self { entries })
+    }
+}
+
+/// FNV-1a hash of a resized line probe and the `config` fields that change
+/// the analysis.
+///
+/// Any change to the resizer's kernel, rounding or edge handling almost
+/// always changes some output pixel of the line probe, which makes this a
+/// cheap stand-in for the whole analysis.
+pub fn fingerprint(line_output: ImgRef<'_, u8>, config: &AnalysisConfig) -> u64 {
+    let mut hash = Fnv1a::new();
+    hash.write(&[
+        config.srgb as u8,
+        config.detect_edges as u8,
+        config.line_probe.rows() as u8,
+    ]);
+    hash.write(&(line_output.width() as u32).to_le_bytes());
+    hash.write(&(line_output.height() as u32).to_le_bytes());
+    for row in line_output.rows() {
+        hash.write(&row[..line_output.width()]);
+    }
+    hash.0
+}
+
+/// Serialize one result in the `result` layout of the [module docs](self).
+pub fn encode_result(result: &AnalysisResult) -> Vec<u8> {
+    let mut w = Writer(Vec::new());
+    write_result(&mut w, result);
+    w.0
+}
+
+/// Parse one result written by [`encode_result`].
+pub fn decode_result(bytes: &[u8]) -> Result<AnalysisResult, Error> {
+    let mut r = Reader { bytes, pos: 0 };
+    let result = read_result(&mut r)?;
+    if r.pos != bytes.len() {
+        return Err(Error::CorruptCache("trailing bytes"));
+    }
+    Ok(result)
+}
+
+struct Fnv1a(u64);
+
+impl Fnv1a {
+    fn new() -> Self {
+        Self(0xcbf2_9ce4_8422_2325)
+    }
+
+    fn write(&mut self, bytes: &[u8]) {
+        for &b in bytes {
+            self.0 = (self.0 ^ b as u64).wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    }
+}
+
+struct Writer(Vec<u8>);
+
+impl Writer {
+    fn u8(&mut self, v: u8) {
+        self.0.push(v);
+    }
+
+    fn u32(&mut self, v: u32) {
+        self.0.extend_from_slice(&v.to_le_bytes());
+    }
+
+    fn u64(&mut self, v: u64) {
+        self.0.extend_from_slice(&v.to_le_bytes());
+    }
+
+    fn f64(&mut self, v: f64) {
+        self.0.extend_from_slice(&v.to_le_bytes());
+    }
+
+    fn pad8(&mut self) {
+        let len = self.0.len().next_multiple_of(8);
+        self.0.resize(len, 0);
+    }
+}
+
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, n: usize) -> Result<&'a [u8], Error> {
+        let end = self
+            .pos
+            .checked_add(n)
+            .filter(|&end| end <= self.bytes.len())
+            .ok_or(Error::CorruptCache("truncated"))?;
+        let slice = &self.bytes[self.pos..end];
+        self.pos = end;
+        Ok(slice)
+    }
+
+    fn array<const N: usize>(&mut self) -> Result<[u8; N], Error> {
+        Ok(self.take(N)?.try_into().expect("took N bytes"))
+    }
+
+    fn u8(&mut self) -> Result<u8, Error> {
+        Ok(self.array::<1>()?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32, Error> {
+        Ok(u32::from_le_bytes(self.array()?))
+    }
+
+    fn u64(&mut self) -> Result<u64, Error> {
+        Ok(u64::from_le_bytes(self.array()?))
+    }
+
+    fn f64(&mut self) -> Result<f64, Error> {
+        Ok(f64::from_le_bytes(self.array()?))
+    }
+
+    fn pad8(&mut self) -> Result<(), Error> {
+        let n = self.pos.next_multiple_of(8) - self.pos;
+        if self.take(n)?.iter().any(|&b| b != 0) {
+            return Err(Error::CorruptCache("nonzero padding"));
+        }
+        Ok(())
+    }
+}
+
+fn write_result(w: &mut Writer, result: &AnalysisResult) {
+    w.u8(result.edge_mode.map_or(NO_EDGE_MODE, edge_mode_code));
+    let curves = [&result.downscale_curve, &result.upscale_curve];
+    let flags = curves
+        .iter()
+        .enumerate()
+        .fold(0, |f, (i, c)| f | ((c.is_some() as u8) << i));
+    w.u8(flags);
+    w.pad8();
+    for curve in curves.into_iter().flatten() {
+        write_curve(w, curve);
+    }
+    w.u32(result.scores.len() as u32);
+    w.pad8();
+    for score in &result.scores {
+        write_score(w, score);
+    }
+}
+
+fn read_result(r: &mut Reader<'_>) -> Result<AnalysisResult, Error> {
+    let edge_mode = match r.u8()? {
+        NO_EDGE_MODE => None,
+        code => Some(edge_mode_from_code(code)?),
+    };
+    let flags = r.u8()?;
+    if flags > 0b11 {
+        return Err(Error::CorruptCache("unknown curve flags"));
+    }
+    r.pad8()?;
+    let downscale_curve = (flags & 1 != 0).then(|| read_curve(r)).transpose()?;
+    let upscale_curve = (flags & 2 != 0).then(|| read_curve(r)).transpose()?;
+    let count = r.u32()? as usize;
+    r.pad8()?;
+    // Bound the allocation by what the buffer can actually hold.
+    let mut scores = Vec::with_capacity(count.min(r.bytes.len() / SCORE_BYTES));
+    for _ in 0..count {
+        scores.push(read_score(r)?);
+    }
+    Ok(AnalysisResult {
+        downscale_curve,
+        upscale_curve,
+        scores,
+        edge_mode,
+    })
+}
+
+fn write_curve(w: &mut Writer, curve: &FilterCurve) {
+    w.u32(curve.points.len() as u32);
+    w.u8(curve.is_scatter as u8);
+    w.pad8();
+    w.f64(curve.area);
+    w.f64(curve.scale_factor);
+    for &(offset, weight) in &curve.points {
+        w.f64(offset);
+        w.f64(weight);
+    }
+}
+
+fn read_curve(r: &mut Reader<'_>) -> Result<FilterCurve, Error> {
+    let count = r.u32()? as usize;
+    let is_scatter = match r.u8()? {
+        0 => false,
+        1 => true,
+        _ => return Err(Error::CorruptCache("bad is_scatter flag")),
+    };
+    r.pad8()?;
+    let area = r.f64()?;
+    let scale_factor = r.f64()?;
+    let raw = r.take(
+        count
+            .checked_mul(16)
+            .ok_or(Error::CorruptCache("truncated"))?,
+    )?;
+    let points = raw
+        .chunks_exact(16)
+        .map(|p| {
+            let offset = f64::from_le_bytes(p[..8].try_into().expect("8 bytes"));
+            let weight = f64::from_le_bytes(p[8..].try_into().expect("8 bytes"));
+            (offset, weight)
+        })
+        .collect();
+    Ok(FilterCurve {
+        points,
+        area,
+        scale_factor,
+        is_scatter,
+    })
+}
+
+/// Encoded size of one score.
+const SCORE_BYTES: usize = 64;
+
+fn write_score(w: &mut Writer, score: &FilterScore) {
+    let (code, params) = filter_code(score.filter);
+    w.u8(code);
+    w.pad8();
+    w.f64(params[0]);
+    w.f64(params[1]);
+    w.f64(score.correlation);
+    w.f64(score.rms_error);
+    w.f64(score.max_error);
+    w.f64(score.detected_support);
+    w.f64(score.expected_support);
+}
+
+fn read_score(r: &mut Reader<'_>) -> Result<FilterScore, Error> {
+    let code = r.u8()?;
+    r.pad8()?;
+    let params = [r.f64()?, r.f64()?];
+    Ok(FilterScore {
+        filter: filter_from_code(code, params)?,
+        correlation: r.f64()?,
+        rms_error: r.f64()?,
+        max_error: r.f64()?,
+        detected_support: r.f64()?,
+        expected_support: r.f64()?,
+    })
+}
+
+fn edge_mode_code(mode: EdgeMode) -> u8 {
+    match mode {
+        EdgeMode::Clamp => 0,
+        EdgeMode::Reflect => 1,
+        EdgeMode::Wrap => 2,
+        EdgeMode::Zero => 3,
+        EdgeMode::Unknown => 4,
+    }
+}
+
+fn edge_mode_from_code(code: u8) -> Result<EdgeMode, Error> {
+    Ok(match code {
+        0 => EdgeMode::Clamp,
+        1 => EdgeMode::Reflect,
+        2 => EdgeMode::Wrap,
+        3 => EdgeMode::Zero,
+        4 => EdgeMode::Unknown,
+        _ => return Err(Error::CorruptCache("unknown edge mode")),
+    })
+}
+
+fn filter_code(filter: KnownFilter) -> (u8, [f64; 2]) {
+    match filter {
+        KnownFilter::Box => (0, [0.0; 2]),
+        KnownFilter::Triangle => (1, [0.0; 2]),
+        KnownFilter::Hermite => (2, [0.0; 2]),
+        KnownFilter::CatmullRom => (3, [0.0; 2]),
+        KnownFilter::Mitchell => (4, [0.0; 2]),
+        KnownFilter::BSpline => (5, [0.0; 2]),
+        KnownFilter::Lanczos2 => (6, [0.0; 2]),
+        KnownFilter::Lanczos3 => (7, [0.0; 2]),
+        KnownFilter::Lanczos4 => (8, [0.0; 2]),
+        KnownFilter::MitchellNetravali { b, c } => (9, [b, c]),
+        KnownFilter::Lanczos { support } => (10, [support, 0.0]),
+    }
+}
+
+fn filter_from_code(code: u8, [p0, p1]: [f64; 2]) -> Result<KnownFilter, Error> {
+    Ok(match code {
+        0 => KnownFilter::Box,
+        1 => KnownFilter::Triangle,
+        2 => KnownFilter::Hermite,
+        3 => KnownFilter::CatmullRom,
+        4 => KnownFilter::Mitchell,
+        5 => KnownFilter::BSpline,
+        6 => KnownFilter::Lanczos2,
+        7 => KnownFilter::Lanczos3,
+        8 => KnownFilter::Lanczos4,
+        9 => KnownFilter::MitchellNetravali { b: p0, c: p1 },
+        10 => KnownFilter::Lanczos { support: p0 },
+        _ => return Err(Error::CorruptCache("unknown filter")),
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::perfect_resize;
+    use crate::test_util::{counted, lanczos3};
+    use imgref::ImgVec;
+    use std::sync::Arc;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    fn mitchell(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        perfect_resize(src, w, h, KnownFilter::Mitchell)
+    }
+
+    fn assert_same(a: &AnalysisResult, b: &AnalysisResult) {
+        assert_eq!(encode_result(a), encode_result(b));
+        let (ca, cb) = (
+            a.upscale_curve.as_ref().unwrap(),
+            b.upscale_curve.as_ref().unwrap(),
+        );
+        assert_eq!(ca.points, cb.points);
+        assert_eq!(ca.area.to_bits(), cb.area.to_bits());
+        assert_eq!(a.scores.len(), b.scores.len());
+        for (sa, sb) in a.scores.iter().zip(&b.scores) {
+            assert_eq!(sa.filter, sb.filter);
+            assert_eq!(sa.correlation.to_bits(), sb.correlation.to_bits());
+        }
+        assert_eq!(a.edge_mode, b.edge_mode);
+    }
+
+    #[test]
+    fn hit_skips_all_but_the_line_probe() {
+        let config = AnalysisConfig::default();
+        let mut cache = AnalysisCache::new();
+
+        let calls = Arc::new(AtomicU64::new(0));
+        let counted_lanczos3 = counted(Arc::clone(&calls), lanczos3);
+        let miss = cache.analyze("l3", &counted_lanczos3, &config).unwrap();
+        let after_miss = calls.load(Ordering::Relaxed);
+        let hit = cache.analyze("l3", &counted_lanczos3, &config).unwrap();
+        let after_hit = calls.load(Ordering::Relaxed);
+
+        assert!(!miss.hit);
+        assert!(hit.hit);
+        assert_eq!(after_miss, 3);
+        assert_eq!(after_hit - after_miss, 1);
+        assert_same(&miss.result, &hit.result);
+        assert_same(&miss.result, &crate::analyze(&lanczos3, &config).unwrap());
+
+        // A different resizer under the same ID is re-analyzed.
+        let changed = cache.analyze("l3", &mitchell, &config).unwrap();
+        assert!(!changed.hit);
+        assert_eq!(changed.result.scores[0].filter, KnownFilter::Mitchell);
+        assert_eq!(cache.len(), 1);
+    }
+
+    #[test]
+    fn bytes_round_trip() {
+        let config = AnalysisConfig::default();
+        let mut cache = AnalysisCache::new();
+        cache.analyze("mitchell", &mitchell, &config).unwrap();
+        let mut result = crate::analyze(&mitchell, &config).unwrap();
+        result.scores[0].filter = KnownFilter::MitchellNetravali { b: 0.3, c: 0.35 };
+        result.downscale_curve = None;
+        result.edge_mode = None;
+        cache.insert(
+            "custom",
+            CacheEntry {
+                fingerprint: 7,
+                result,
+            },
+        );
+
+        let bytes = cache.to_bytes();
+        let loaded = AnalysisCache::from_bytes(&bytes).unwrap();
+        assert_eq!(loaded.to_bytes(), bytes);
+        assert_eq!(loaded.len(), 2);
+        for ((id_a, a), (id_b, b)) in cache.iter().zip(loaded.iter()) {
+            assert_eq!(id_a, id_b);
+            assert_eq!(a.fingerprint, b.fingerprint);
+            assert_same(&a.result, &b.result);
+        }
+        let custom = &loaded.get("custom").unwrap().result;
+        assert!(custom.downscale_curve.is_none());
+        assert!(matches!(
+            custom.scores[0].filter,
+            KnownFilter::MitchellNetravali { b: 0.3, c: 0.35 }
+        ));
+
+        // Loaded fingerprints still produce hits.
+        let mut loaded = loaded;
+        assert!(loaded.analyze("mitchell", &mitchell, &config).unwrap().hit);
+    }
+
+    #[test]
+    fn curve_points_are_aligned() {
+        let result = crate::analyze(&mitchell, &AnalysisConfig::default()).unwrap();
+        let bytes = encode_result(&result);
+        let curve = result.downscale_curve.as_ref().unwrap();
+        // Header (8) + point count and flag, padded (8) + area + scale (16).
+        let first = &bytes[32..48];
+        assert_eq!(
+            f64::from_le_bytes(first[..8].try_into().unwrap()),
+            curve.points[0].0
+        );
+        assert_eq!(
+            f64::from_le_bytes(first[8..].try_into().unwrap()),
+            curve.points[0].1
+        );
+    }
+
+    #[test]
+    fn rejects_corrupt_bytes() {
+        let config = AnalysisConfig::default();
+        let mut cache = AnalysisCache::new();
+        cache.analyze("mitchell", &mitchell, &config).unwrap();
+        let bytes = cache.to_bytes();
+
+        for len in [0, 7, 16, bytes.len() / 2, bytes.len() - 1] {
+            assert!(matches!(
+                AnalysisCache::from_bytes(&bytes[..len]),
+                Err(Error::CorruptCache(_))
+            ));
+        }
+        let mut bad = bytes.clone();
+        bad[8] = 99;
+        assert!(matches!(
+            AnalysisCache::from_bytes(&bad),
+            Err(Error::CorruptCache("unsupported format version"))
+        ));
+        let mut long = bytes;
+        long.push(0);
+        assert!(AnalysisCache::from_bytes(&long).is_err());
+    }
+}
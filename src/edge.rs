@@ -1,4 +1,8 @@
-use crate::pattern::{self, BRIGHT, DARK, LINE_DST_WIDTH, LINE_SRC_WIDTH};
+use imgref::ImgRef;
+
+use crate::LineProbe;
+use crate::pattern::{LINE_DST_WIDTH, LINE_SRC_WIDTH};
+use crate::pixel::ProbePixel;
 
 /// Detected edge handling mode.
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -33,31 +37,60 @@ impl std::fmt::Display for EdgeMode {
 /// resizes it, then analyzes the asymmetry of the filter response near the
 /// boundary to classify the edge handling strategy.
 pub fn detect(resize: &crate::ResizeFn) -> EdgeMode {
-    let edge_img = pattern::generate_edge_pattern();
+    detect_as::<u8>(resize)
+}
+
+/// [`detect`] for a resizer working in another [`ProbePixel`] format.
+pub fn detect_as<T: ProbePixel>(resize: &crate::ResizeFnOf<T>) -> EdgeMode {
+    detect_with(resize, LineProbe::Full)
+}
+
+/// [`detect_as`] with an edge probe of the height `probe` selects.
+pub fn detect_with<T: ProbePixel>(resize: &crate::ResizeFnOf<T>, probe: LineProbe) -> EdgeMode {
+    let edge_img = probe.crop(T::patterns().edge.as_ref());
     let dst_w = LINE_DST_WIDTH;
     let dst_h = edge_img.height();
-    let resized = resize(edge_img.as_ref(), dst_w, dst_h);
+    let resized = resize(edge_img, dst_w, dst_h);
 
     if resized.width() != dst_w || resized.height() != dst_h {
         return EdgeMode::Unknown;
     }
 
-    let scale_factor = dst_w as f64 / LINE_SRC_WIDTH as f64;
+    classify(resized.as_ref())
+}
+
+/// Classify the edge handling from an edge pattern already resized to
+/// `LINE_DST_WIDTH` columns, as [`detect`] does after calling the resizer.
+pub fn classify<T: ProbePixel>(resized: ImgRef<'_, T>) -> EdgeMode {
+    let dst_w = resized.width();
+    if dst_w != LINE_DST_WIDTH || resized.height() == 0 {
+        return EdgeMode::Unknown;
+    }
+
     let scanline = resized.height() / 2;
-    let row = &resized.buf()[scanline * resized.stride()..][..dst_w];
+    classify_scanline(&resized.buf()[scanline * resized.stride()..][..dst_w])
+}
+
+/// [`classify`] from just the middle scanline (row `height / 2`) of the
+/// resized edge pattern, which is the only row the classification reads.
+pub fn classify_scanline<T: ProbePixel>(row: &[T]) -> EdgeMode {
+    let dst_w = row.len();
+    if dst_w != LINE_DST_WIDTH {
+        return EdgeMode::Unknown;
+    }
+
+    let scale_factor = dst_w as f64 / LINE_SRC_WIDTH as f64;
 
     // Convert to normalized weights.
-    let weights: Vec<f64> = row
-        .iter()
-        .map(|&v| (v as f64 - DARK as f64) / (BRIGHT as f64 - DARK as f64))
-        .collect();
+    let decode = T::weight_decoder(false);
+    let weights: Vec<f64> = row.iter().map(|&v| decode(v)).collect();
 
     // Find the peak (should be near x=1 * scale_factor).
     let expected_peak = ((1.0 + 0.5) * scale_factor - 0.5) as usize;
     let search_start = expected_peak.saturating_sub(5);
     let search_end = (expected_peak + 6).min(dst_w);
     let peak_idx = (search_start..search_end)
-        .max_by(|&a, &b| weights[a].partial_cmp(&weights[b]).unwrap())
+        .max_by(|&a, &b| weights[a].total_cmp(&weights[b]))
         .unwrap_or(expected_peak);
 
     // Compute energy on each side of the peak.
@@ -116,7 +149,7 @@ pub fn detect(resize: &crate::ResizeFn) -> EdgeMode {
 #[cfg(test)]
 mod tests {
     use super::*;
-    use imgref::{ImgRef, ImgVec};
+    use imgref::ImgVec;
 
     /// Clamp-based nearest-neighbor resize.
     fn nn_resize(src: ImgRef<'_, u8>, dst_w: usize, dst_h: usize) -> ImgVec<u8> {
@@ -0,0 +1,161 @@
+//! Continuous parameter fits for the parametric filter families.
+//!
+//! [`score_against_all`](crate::score::score_against_all) only compares against
+//! the fixed [`KnownFilter::all_named`] list, so a resizer using, say, a custom
+//! Mitchell-Netravali cubic gets a mediocre nearest match. The fitters here
+//! search the family's parameter space directly: a coarse grid first, then a
+//! shrinking-step pattern search around the best grid point. Every round scores
+//! its candidates together in one [`PreparedCurve::score_many`] pass, so the
+//! curve is binned once and each candidate costs one walk over the bins.
+//!
+//! Candidates are ranked by RMS error; correlation is insensitive to the
+//! overall gain and so cannot tell neighboring parameters apart well.
+
+use crate::filters::KnownFilter;
+use crate::score::{FilterScore, PreparedCurve};
+
+/// Range searched for both `B` and `C` by [`fit_cubic`].
+pub const CUBIC_RANGE: (f64, f64) = (0.0, 1.0);
+
+/// Range of supports searched by [`fit_lanczos`].
+pub const LANCZOS_RANGE: (f64, f64) = (1.0, 8.0);
+
+/// Refinement stops once the step size falls below this.
+const TOLERANCE: f64 = 1e-4;
+
+/// Hard cap on refinement rounds, in case of a flat objective.
+const MAX_ROUNDS: usize = 200;
+
+/// Fit `KnownFilter::MitchellNetravali { b, c }` to `curve`.
+///
+/// Searches an 11x11 grid over [`CUBIC_RANGE`] (step 0.1) and refines to about
+/// 1e-4. The returned score's `filter` holds the fitted `B` and `C`.
+pub fn fit_cubic(curve: &PreparedCurve) -> FilterScore {
+    let (lo, hi) = CUBIC_RANGE;
+    let cubic = |b: f64, c: f64| KnownFilter::MitchellNetravali { b, c };
+
+    let steps = 10;
+    let step = (hi - lo) / steps as f64;
+    let grid: Vec<KnownFilter> = (0..=steps)
+        .flat_map(|i| (0..=steps).map(move |j| (i, j)))
+        .map(|(i, j)| cubic(lo + i as f64 * step, lo + j as f64 * step))
+        .collect();
+    let start = best_by_rms(curve.score_many(&grid));
+
+    refine(curve, start, step / 2.0, |filter, step| {
+        let KnownFilter::MitchellNetravali { b, c } = filter else {
+            unreachable!("cubic fit only produces cubics")
+        };
+        let mut around = Vec::with_capacity(8);
+        for db in [-step, 0.0, step] {
+            for dc in [-step, 0.0, step] {
+                if db != 0.0 || dc != 0.0 {
+                    around.push(cubic((b + db).clamp(lo, hi), (c + dc).clamp(lo, hi)));
+                }
+            }
+        }
+        around
+    })
+}
+
+/// Fit `KnownFilter::Lanczos { support }` to `curve`.
+///
+/// Searches [`LANCZOS_RANGE`] in steps of 0.25 and refines to about 1e-4. The
+/// returned score's `filter` holds the fitted support.
+///
+/// Only the support is fitted. The window is the standard `sinc(x / support)`
+/// tied to that support; a sinc with a separately sized window is not modeled.
+pub fn fit_lanczos(curve: &PreparedCurve) -> FilterScore {
+    let (lo, hi) = LANCZOS_RANGE;
+    let lanczos = |support: f64| KnownFilter::Lanczos { support };
+
+    let step = 0.25;
+    let steps = ((hi - lo) / step).round() as usize;
+    let grid: Vec<KnownFilter> = (0..=steps).map(|i| lanczos(lo + i as f64 * step)).collect();
+    let start = best_by_rms(curve.score_many(&grid));
+
+    refine(curve, start, step / 2.0, |filter, step| {
+        let KnownFilter::Lanczos { support } = filter else {
+            unreachable!("Lanczos fit only produces Lanczos filters")
+        };
+        vec![
+            lanczos((support - step).clamp(lo, hi)),
+            lanczos((support + step).clamp(lo, hi)),
+        ]
+    })
+}
+
+/// Pattern search: move to the best neighbor while one improves on the current
+/// point, otherwise halve the step, until the step drops below [`TOLERANCE`].
+fn refine(
+    curve: &PreparedCurve,
+    mut best: FilterScore,
+    mut step: f64,
+    neighbors: impl Fn(KnownFilter, f64) -> Vec<KnownFilter>,
+) -> FilterScore {
+    for _ in 0..MAX_ROUNDS {
+        if step < TOLERANCE {
+            break;
+        }
+        let candidate = best_by_rms(curve.score_many(&neighbors(best.filter, step)));
+        if candidate.rms_error < best.rms_error {
+            best = candidate;
+        } else {
+            step /= 2.0;
+        }
+    }
+    best
+}
+
+fn best_by_rms(scores: Vec<FilterScore>) -> FilterScore {
+    scores
+        .into_iter()
+        .min_by(|a, b| {
+            a.rms_error
+                .partial_cmp(&b.rms_error)
+                .unwrap_or(std::cmp::Ordering::Equal)
+        })
+        .expect("at least one candidate")
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::analyze::FilterCurve;
+
+    fn sampled(filter: KnownFilter) -> PreparedCurve {
+        let points = (-500..=500)
+            .map(|i| {
+                let x = i as f64 / 100.0;
+                (x, filter.evaluate(x))
+            })
+            .collect();
+        PreparedCurve::new(&FilterCurve {
+            points,
+            area: 1.0,
+            scale_factor: 37.0,
+            is_scatter: false,
+        })
+    }
+
+    #[test]
+    fn recovers_off_grid_cubic() {
+        let fit = fit_cubic(&sampled(KnownFilter::MitchellNetravali {
+            b: 0.23,
+            c: 0.41,
+        }));
+        let KnownFilter::MitchellNetravali { b, c } = fit.filter else {
+            panic!("not a cubic: {}", fit.filter)
+        };
+        assert!((b - 0.23).abs() < 1e-3, "b = {b}");
+        assert!((c - 0.41).abs() < 1e-3, "c = {c}");
+        assert!(fit.rms_error < 1e-4, "rms = {}", fit.rms_error);
+    }
+
+    #[test]
+    fn recovers_fractional_lanczos_support() {
+        let fit = fit_lanczos(&sampled(KnownFilter::Lanczos { support: 2.7 }));
+        assert!((fit.filter.support() - 2.7).abs() < 1e-3, "{}", fit.filter);
+        assert!(fit.rms_error < 1e-4, "rms = {}", fit.rms_error);
+    }
+}
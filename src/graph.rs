@@ -1,8 +1,11 @@
-use imgref::ImgVec;
+use std::fmt::Write;
+use std::sync::OnceLock;
+
+use imgref::{ImgRef, ImgRefMut, ImgVec};
 use rgb::RGB8;
 
 use crate::analyze::FilterCurve;
-use crate::filters::KnownFilter;
+use crate::filters::{Kernel, KnownFilter};
 
 const WIDTH: usize = 600;
 const HEIGHT: usize = 300;
@@ -47,45 +50,61 @@ fn ycoord(iy: f64) -> i32 {
     (0.5 + ZERO_Y + iy * UNIT_Y) as i32
 }
 
-fn set_pixel(buf: &mut [RGB8], x: i32, y: i32, color: RGB8) {
-    if x >= 0 && x < WIDTH as i32 && y >= 0 && y < HEIGHT as i32 {
-        buf[y as usize * WIDTH + x as usize] = color;
-    }
+/// A `WIDTH` x `HEIGHT` drawing target with any row stride.
+struct Raster<'a> {
+    buf: &'a mut [RGB8],
+    stride: usize,
 }
 
-fn draw_line(buf: &mut [RGB8], x0: i32, y0: i32, x1: i32, y1: i32, color: RGB8) {
-    let dx = (x1 - x0).abs();
-    let dy = -(y1 - y0).abs();
-    let sx: i32 = if x0 < x1 { 1 } else { -1 };
-    let sy: i32 = if y0 < y1 { 1 } else { -1 };
-    let mut err = dx + dy;
-    let mut x = x0;
-    let mut y = y0;
+impl<'a> Raster<'a> {
+    fn new(buf: &'a mut [RGB8], stride: usize) -> Self {
+        Self { buf, stride }
+    }
 
-    loop {
-        set_pixel(buf, x, y, color);
-        if x == x1 && y == y1 {
-            break;
+    fn inside(x: i32, y: i32) -> bool {
+        x >= 0 && x < WIDTH as i32 && y >= 0 && y < HEIGHT as i32
+    }
+
+    fn set_pixel(&mut self, x: i32, y: i32, color: RGB8) {
+        if Self::inside(x, y) {
+            self.buf[y as usize * self.stride + x as usize] = color;
         }
-        let e2 = 2 * err;
-        if e2 >= dy {
-            if x == x1 {
-                break;
-            }
-            err += dy;
-            x += sx;
+    }
+
+    /// Plot every point `line` visits. A Bresenham line stays within the
+    /// bounding box of its endpoints, so a line with both ends on the canvas
+    /// is written without per-pixel clipping, and one with both ends past the
+    /// same edge is skipped outright.
+    fn plot_line(&mut self, line: Line, mut keep: impl FnMut() -> bool, color: RGB8) {
+        let Line(x0, y0, x1, y1) = line;
+        let (w, h) = (WIDTH as i32, HEIGHT as i32);
+        if (x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0) || (x0 >= w && x1 >= w) || (y0 >= h && y1 >= h)
+        {
+            return;
         }
-        if e2 <= dx {
-            if y == y1 {
-                break;
-            }
-            err += dx;
-            y += sy;
+        let stride = self.stride;
+        if Self::inside(x0, y0) && Self::inside(x1, y1) {
+            let buf = &mut *self.buf;
+            bresenham(line, |x, y| {
+                if keep() {
+                    buf[y as usize * stride + x as usize] = color;
+                }
+            });
+        } else {
+            bresenham(line, |x, y| {
+                if keep() {
+                    self.set_pixel(x, y, color);
+                }
+            });
         }
     }
 }
 
-fn draw_dashed_line(buf: &mut [RGB8], x0: i32, y0: i32, x1: i32, y1: i32, color: RGB8) {
+/// A line segment from `(x0, y0)` to `(x1, y1)`, in pixels.
+#[derive(Clone, Copy)]
+struct Line(i32, i32, i32, i32);
+
+fn bresenham(Line(x0, y0, x1, y1): Line, mut plot: impl FnMut(i32, i32)) {
     let dx = (x1 - x0).abs();
     let dy = -(y1 - y0).abs();
     let sx: i32 = if x0 < x1 { 1 } else { -1 };
@@ -93,14 +112,9 @@ fn draw_dashed_line(buf: &mut [RGB8], x0: i32, y0: i32, x1: i32, y1: i32, color:
     let mut err = dx + dy;
     let mut x = x0;
     let mut y = y0;
-    let mut step = 0u32;
 
     loop {
-        // 4 on, 4 off pattern matching gdImageDashedLine
-        if step % 8 < 4 {
-            set_pixel(buf, x, y, color);
-        }
-        step += 1;
+        plot(x, y);
         if x == x1 && y == y1 {
             break;
         }
@@ -122,108 +136,439 @@ fn draw_dashed_line(buf: &mut [RGB8], x0: i32, y0: i32, x1: i32, y1: i32, color:
     }
 }
 
-fn draw_grid(buf: &mut [RGB8]) {
+fn draw_line(r: &mut Raster, x0: i32, y0: i32, x1: i32, y1: i32, color: RGB8) {
+    r.plot_line(Line(x0, y0, x1, y1), || true, color);
+}
+
+fn draw_dashed_line(r: &mut Raster, x0: i32, y0: i32, x1: i32, y1: i32, color: RGB8) {
+    // 4 on, 4 off pattern matching gdImageDashedLine
+    let mut step = 0u32;
+    let dash = || {
+        step += 1;
+        (step - 1) % 8 < 4
+    };
+    r.plot_line(Line(x0, y0, x1, y1), dash, color);
+}
+
+fn draw_grid(r: &mut Raster) {
     // Dashed lines at half-integers
     for i in -10..=10 {
         let hx = xcoord(0.5 + i as f64);
-        draw_dashed_line(buf, hx, 0, hx, HEIGHT as i32 - 1, GRID_GRAY);
+        draw_dashed_line(r, hx, 0, hx, HEIGHT as i32 - 1, GRID_GRAY);
         let hy = ycoord(0.5 + i as f64);
-        draw_dashed_line(buf, 0, hy, WIDTH as i32 - 1, hy, GRID_GRAY);
+        draw_dashed_line(r, 0, hy, WIDTH as i32 - 1, hy, GRID_GRAY);
     }
 
     // Solid lines at integers
     for i in -10..=10 {
         let ix = xcoord(i as f64);
-        draw_line(buf, ix, 0, ix, HEIGHT as i32 - 1, GRID_GRAY);
+        draw_line(r, ix, 0, ix, HEIGHT as i32 - 1, GRID_GRAY);
         let iy = ycoord(i as f64);
-        draw_line(buf, 0, iy, WIDTH as i32 - 1, iy, GRID_GRAY);
+        draw_line(r, 0, iy, WIDTH as i32 - 1, iy, GRID_GRAY);
     }
 
     // Axes
     let ax = xcoord(0.0);
-    draw_line(buf, ax, 0, ax, HEIGHT as i32 - 1, BLACK);
+    draw_line(r, ax, 0, ax, HEIGHT as i32 - 1, BLACK);
     let ay = ycoord(0.0);
-    draw_line(buf, 0, ay, WIDTH as i32 - 1, ay, BLACK);
+    draw_line(r, 0, ay, WIDTH as i32 - 1, ay, BLACK);
 }
 
-fn draw_border(buf: &mut [RGB8], color: RGB8) {
+fn draw_border(r: &mut Raster, color: RGB8) {
     let w = WIDTH as i32;
     let h = HEIGHT as i32;
-    draw_line(buf, 0, 0, w - 1, 0, color);
-    draw_line(buf, 0, h - 1, w - 1, h - 1, color);
-    draw_line(buf, 0, 0, 0, h - 1, color);
-    draw_line(buf, w - 1, 0, w - 1, h - 1, color);
+    draw_line(r, 0, 0, w - 1, 0, color);
+    draw_line(r, 0, h - 1, w - 1, h - 1, color);
+    draw_line(r, 0, 0, 0, h - 1, color);
+    draw_line(r, w - 1, 0, w - 1, h - 1, color);
 }
 
-fn plot_scatter(buf: &mut [RGB8], points: &[(f64, f64)], color: RGB8) {
+fn plot_scatter(r: &mut Raster, points: &[(f64, f64)], color: RGB8) {
     for &(x, y) in points {
         let px = xcoord(x);
         let py = ycoord(y);
-        set_pixel(buf, px, py, color);
+        r.set_pixel(px, py, color);
     }
 }
 
-fn plot_connected(buf: &mut [RGB8], points: &[(f64, f64)], color: RGB8) {
+fn plot_connected(r: &mut Raster, points: &[(f64, f64)], color: RGB8) {
     let mut last: Option<(i32, i32)> = None;
     for &(x, y) in points {
         let px = xcoord(x);
         let py = ycoord(y);
         if let Some((lx, ly)) = last {
-            draw_line(buf, lx, ly, px, py, color);
+            draw_line(r, lx, ly, px, py, color);
         }
         last = Some((px, py));
     }
 }
 
-fn plot_reference(buf: &mut [RGB8], filter: KnownFilter, color: RGB8) {
-    // Sample the reference filter densely across the visible range.
+/// Pixel coordinates of the reference overlay: the filter sampled densely
+/// across the visible range.
+fn reference_trace(kernel: &dyn Kernel) -> Vec<(i32, i32)> {
     let x_min = -ZERO_X / UNIT_X; // leftmost visible logical x
     let x_max = (WIDTH as f64 - ZERO_X) / UNIT_X; // rightmost visible logical x
 
     let steps = WIDTH * 2;
-    let mut last: Option<(i32, i32)> = None;
-    for i in 0..=steps {
-        let x = x_min + (x_max - x_min) * i as f64 / steps as f64;
-        let y = filter.evaluate(x);
-        let px = xcoord(x);
-        let py = ycoord(y);
-        if let Some((lx, ly)) = last {
-            draw_line(buf, lx, ly, px, py, color);
+    (0..=steps)
+        .map(|i| {
+            let x = x_min + (x_max - x_min) * i as f64 / steps as f64;
+            (xcoord(x), ycoord(kernel.evaluate(x)))
+        })
+        .collect()
+}
+
+fn draw_polyline(r: &mut Raster, trace: &[(i32, i32)], color: RGB8) {
+    for pair in trace.windows(2) {
+        let ((lx, ly), (px, py)) = (pair[0], pair[1]);
+        draw_line(r, lx, ly, px, py, color);
+    }
+}
+
+/// White background with the grid and axes, drawn once and shared.
+fn background() -> &'static [RGB8] {
+    static BACKGROUND: OnceLock<Vec<RGB8>> = OnceLock::new();
+    BACKGROUND.get_or_init(|| {
+        let mut buf = vec![WHITE; WIDTH * HEIGHT];
+        draw_grid(&mut Raster::new(&mut buf, WIDTH));
+        buf
+    })
+}
+
+/// A reusable graph image.
+///
+/// Each render copies in the shared background (grid and axes), plots the
+/// curves and redraws the border, so the per-graph cost is a copy plus the
+/// curve plots. The overlay trace of the last [`KnownFilter`] passed to
+/// [`render`](Self::render) is kept, so rendering many graphs against the
+/// same reference evaluates the filter once.
+///
+/// [`render_into`](Self::render_into) draws into a caller's image instead,
+/// such as a tile of a larger contact sheet.
+#[derive(Debug, Clone)]
+pub struct GraphCanvas {
+    img: ImgVec<RGB8>,
+    reference: Option<(KnownFilter, Vec<(i32, i32)>)>,
+}
+
+impl GraphCanvas {
+    /// A blank 600x300 canvas.
+    pub fn new() -> Self {
+        Self {
+            img: ImgVec::new(background().to_vec(), WIDTH, HEIGHT),
+            reference: None,
         }
-        last = Some((px, py));
     }
+
+    /// The most recently rendered graph.
+    pub fn image(&self) -> &ImgVec<RGB8> {
+        &self.img
+    }
+
+    /// Take the image out of the canvas.
+    pub fn into_image(self) -> ImgVec<RGB8> {
+        self.img
+    }
+
+    /// Draw the same graph as [`render`](fn@render) into this canvas.
+    pub fn render(
+        &mut self,
+        downscale: Option<&FilterCurve>,
+        upscale: Option<&FilterCurve>,
+        reference: Option<KnownFilter>,
+    ) -> &ImgVec<RGB8> {
+        let trace = cached_trace(&mut self.reference, reference);
+        draw(&mut self.img.as_mut(), downscale, upscale, trace);
+        &self.img
+    }
+
+    /// [`render`](Self::render) into `dst` instead of the canvas's own image.
+    /// `dst` may have any stride; the canvas image is left untouched.
+    ///
+    /// # Panics
+    ///
+    /// If `dst` is not 600x300.
+    pub fn render_into(
+        &mut self,
+        dst: &mut ImgRefMut<'_, RGB8>,
+        downscale: Option<&FilterCurve>,
+        upscale: Option<&FilterCurve>,
+        reference: Option<KnownFilter>,
+    ) {
+        let trace = cached_trace(&mut self.reference, reference);
+        draw(dst, downscale, upscale, trace);
+    }
+
+    /// Draw the same graph as [`render_with_kernel`] into this canvas. The
+    /// overlay is sampled from `reference` on every call.
+    pub fn render_with_kernel(
+        &mut self,
+        downscale: Option<&FilterCurve>,
+        upscale: Option<&FilterCurve>,
+        reference: Option<&dyn Kernel>,
+    ) -> &ImgVec<RGB8> {
+        let trace = reference.map(reference_trace);
+        draw(&mut self.img.as_mut(), downscale, upscale, trace.as_deref());
+        &self.img
+    }
+}
+
+impl Default for GraphCanvas {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// The overlay trace for `reference`, from `cache` if it holds the same filter.
+fn cached_trace(
+    cache: &mut Option<(KnownFilter, Vec<(i32, i32)>)>,
+    reference: Option<KnownFilter>,
+) -> Option<&[(i32, i32)]> {
+    let filter = reference?;
+    if cache.as_ref().is_none_or(|(f, _)| *f != filter) {
+        *cache = Some((filter, reference_trace(&filter)));
+    }
+    cache.as_ref().map(|(_, t)| t.as_slice())
+}
+
+/// Background copy, curves, border: the drawing order of every graph.
+fn draw(
+    img: &mut ImgRefMut<'_, RGB8>,
+    downscale: Option<&FilterCurve>,
+    upscale: Option<&FilterCurve>,
+    reference: Option<&[(i32, i32)]>,
+) {
+    assert_eq!(
+        (img.width(), img.height()),
+        (WIDTH, HEIGHT),
+        "graph image must be {WIDTH}x{HEIGHT}"
+    );
+    let stride = img.stride();
+    let buf = &mut img.buf_mut()[..];
+    for (y, row) in background().chunks_exact(WIDTH).enumerate() {
+        buf[y * stride..][..WIDTH].copy_from_slice(row);
+    }
+    let r = &mut Raster::new(buf, stride);
+
+    if let Some(trace) = reference {
+        draw_polyline(r, trace, REF_LIGHT);
+    }
+
+    if let Some(ds) = downscale {
+        plot_scatter(r, &ds.points, SCATTER_BLUE);
+    }
+
+    if let Some(us) = upscale {
+        plot_connected(r, &us.points, LINE_RED);
+    }
+
+    draw_border(r, BORDER_GREEN);
 }
 
 /// Render a scope graph showing the reconstructed filter curve(s).
+///
+/// Allocates a new image; use a [`GraphCanvas`] to render many graphs.
 pub fn render(
     downscale: Option<&FilterCurve>,
     upscale: Option<&FilterCurve>,
     reference: Option<KnownFilter>,
 ) -> ImgVec<RGB8> {
-    let mut buf = vec![WHITE; WIDTH * HEIGHT];
+    render_with_kernel(
+        downscale,
+        upscale,
+        reference.as_ref().map(|f| f as &dyn Kernel),
+    )
+}
+
+/// [`render`] with the reference overlay drawn from any [`Kernel`], such as a
+/// prebuilt [`FilterTable`](crate::filters::FilterTable).
+pub fn render_with_kernel(
+    downscale: Option<&FilterCurve>,
+    upscale: Option<&FilterCurve>,
+    reference: Option<&dyn Kernel>,
+) -> ImgVec<RGB8> {
+    let mut canvas = GraphCanvas::new();
+    canvas.render_with_kernel(downscale, upscale, reference);
+    canvas.into_image()
+}
+
+fn hex(color: RGB8) -> String {
+    format!("#{:02x}{:02x}{:02x}", color.r, color.g, color.b)
+}
+
+/// The center of pixel `v` in SVG user units.
+fn center(v: i32) -> f64 {
+    v as f64 + 0.5
+}
+
+/// Append an SVG path of `lines` (pixel-space endpoints) to `out`. Coordinates
+/// are pixel centers, so one-pixel strokes land on the same pixels the raster
+/// graph sets.
+fn svg_lines(out: &mut String, lines: &[(i32, i32, i32, i32)], color: RGB8, dashed: bool) {
+    if lines.is_empty() {
+        return;
+    }
+    let _ = write!(out, r#"<path stroke="{}" d=""#, hex(color));
+    for &(x0, y0, x1, y1) in lines {
+        let _ = write!(
+            out,
+            "M{} {}L{} {}",
+            center(x0),
+            center(y0),
+            center(x1),
+            center(y1)
+        );
+    }
+    out.push('"');
+    if dashed {
+        out.push_str(r#" stroke-dasharray="4 4""#);
+    }
+    out.push_str("/>\n");
+}
+
+/// Grid lines inside the canvas at `coords` (pixel columns or rows).
+fn grid_lines(coords: impl Iterator<Item = f64>, vertical: bool) -> Vec<(i32, i32, i32, i32)> {
+    let (w, h) = (WIDTH as i32, HEIGHT as i32);
+    coords
+        .filter_map(|v| {
+            if vertical {
+                let x = xcoord(v);
+                (0..w).contains(&x).then_some((x, 0, x, h - 1))
+            } else {
+                let y = ycoord(v);
+                (0..h).contains(&y).then_some((0, y, w - 1, y))
+            }
+        })
+        .collect()
+}
+
+fn svg_polyline(out: &mut String, trace: &[(i32, i32)], color: RGB8) {
+    if trace.len() < 2 {
+        return;
+    }
+    let _ = write!(out, r#"<polyline stroke="{}" points=""#, hex(color));
+    let mut last = None;
+    for &p in trace {
+        if last != Some(p) {
+            let _ = write!(out, "{},{} ", center(p.0), center(p.1));
+            last = Some(p);
+        }
+    }
+    out.push_str("\"/>\n");
+}
+
+/// The graph of [`render`](fn@render) as a standalone SVG document, drawn
+/// through the same coordinate mapping.
+///
+/// Scatter points that fall on the same pixel are written once, so a dot
+/// curve of ~13k points becomes a few thousand one-pixel squares.
+pub fn render_svg(
+    downscale: Option<&FilterCurve>,
+    upscale: Option<&FilterCurve>,
+    reference: Option<KnownFilter>,
+) -> String {
+    render_svg_with_kernel(
+        downscale,
+        upscale,
+        reference.as_ref().map(|f| f as &dyn Kernel),
+    )
+}
+
+/// [`render_svg`] with the reference overlay drawn from any [`Kernel`].
+pub fn render_svg_with_kernel(
+    downscale: Option<&FilterCurve>,
+    upscale: Option<&FilterCurve>,
+    reference: Option<&dyn Kernel>,
+) -> String {
+    let mut out = String::with_capacity(32 * 1024);
+    let _ = writeln!(
+        out,
+        r#"<svg xmlns="http://www.w3.org/2000/svg" width="{WIDTH}" height="{HEIGHT}" viewBox="0 0 {WIDTH} {HEIGHT}" fill="none" stroke-width="1" stroke-linecap="square" shape-rendering="crispEdges">"#
+    );
+    let _ = writeln!(
+        out,
+        r#"<rect width="{WIDTH}" height="{HEIGHT}" fill="{}"/>"#,
+        hex(WHITE)
+    );
 
-    draw_grid(&mut buf);
+    let halves = || (-10..=10).map(|i| 0.5 + i as f64);
+    let integers = || (-10..=10).map(|i| i as f64);
+    let mut dashed = grid_lines(halves(), true);
+    dashed.extend(grid_lines(halves(), false));
+    svg_lines(&mut out, &dashed, GRID_GRAY, true);
+    let mut solid = grid_lines(integers(), true);
+    solid.extend(grid_lines(integers(), false));
+    svg_lines(&mut out, &solid, GRID_GRAY, false);
+    let mut axes = grid_lines(std::iter::once(0.0), true);
+    axes.extend(grid_lines(std::iter::once(0.0), false));
+    svg_lines(&mut out, &axes, BLACK, false);
 
-    if let Some(filter) = reference {
-        plot_reference(&mut buf, filter, REF_LIGHT);
+    if let Some(kernel) = reference {
+        svg_polyline(&mut out, &reference_trace(kernel), REF_LIGHT);
     }
 
     if let Some(ds) = downscale {
-        plot_scatter(&mut buf, &ds.points, SCATTER_BLUE);
+        let mut seen = vec![false; WIDTH * HEIGHT];
+        let _ = write!(out, r#"<path fill="{}" d=""#, hex(SCATTER_BLUE));
+        for &(x, y) in &ds.points {
+            let (px, py) = (xcoord(x), ycoord(y));
+            if (0..WIDTH as i32).contains(&px) && (0..HEIGHT as i32).contains(&py) {
+                let i = py as usize * WIDTH + px as usize;
+                if !std::mem::replace(&mut seen[i], true) {
+                    let _ = write!(out, "M{px} {py}h1v1h-1z");
+                }
+            }
+        }
+        out.push_str("\"/>\n");
     }
 
     if let Some(us) = upscale {
-        plot_connected(&mut buf, &us.points, LINE_RED);
+        let trace: Vec<(i32, i32)> = us
+            .points
+            .iter()
+            .map(|&(x, y)| (xcoord(x), ycoord(y)))
+            .collect();
+        svg_polyline(&mut out, &trace, LINE_RED);
     }
 
-    draw_border(&mut buf, BORDER_GREEN);
+    let _ = writeln!(
+        out,
+        r#"<rect x="0.5" y="0.5" width="{}" height="{}" stroke="{}"/>"#,
+        WIDTH - 1,
+        HEIGHT - 1,
+        hex(BORDER_GREEN)
+    );
+    out.push_str("</svg>\n");
+    out
+}
 
-    ImgVec::new(buf, WIDTH, HEIGHT)
+/// Shrink a graph by `factor` in each direction for list views, e.g. 600x300
+/// to 150x75 at 4.
+///
+/// Each output pixel takes the darkest pixel of its `factor` x `factor`
+/// block, so one-pixel curves and axes stay visible instead of fading into
+/// the background as they would with averaging. A `factor` of 0 is treated
+/// as 1.
+pub fn thumbnail(graph: ImgRef<'_, RGB8>, factor: usize) -> ImgVec<RGB8> {
+    let factor = factor.max(1);
+    let (w, h) = (graph.width() / factor, graph.height() / factor);
+    let luma = |p: &RGB8| p.r as u32 + p.g as u32 + p.b as u32;
+    let mut buf = Vec::with_capacity(w * h);
+    for ty in 0..h {
+        let rows = &graph.buf()[ty * factor * graph.stride()..];
+        for tx in 0..w {
+            let block = (0..factor)
+                .flat_map(|dy| rows[dy * graph.stride() + tx * factor..][..factor].iter());
+            buf.push(*block.min_by_key(|p| luma(p)).expect("factor >= 1"));
+        }
+    }
+    ImgVec::new(buf, w, h)
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::test_util::lanczos3;
 
     #[test]
     fn render_empty_graph() {
@@ -234,6 +579,140 @@ mod tests {
         assert_eq!(img.buf()[0], BORDER_GREEN);
     }
 
+    /// The original draw order, everything rasterized from scratch.
+    fn render_from_scratch(
+        downscale: Option<&FilterCurve>,
+        upscale: Option<&FilterCurve>,
+        reference: Option<KnownFilter>,
+    ) -> Vec<RGB8> {
+        let mut buf = vec![WHITE; WIDTH * HEIGHT];
+        let r = &mut Raster::new(&mut buf, WIDTH);
+        draw_grid(r);
+        if let Some(filter) = reference {
+            draw_polyline(r, &reference_trace(&filter), REF_LIGHT);
+        }
+        if let Some(ds) = downscale {
+            plot_scatter(r, &ds.points, SCATTER_BLUE);
+        }
+        if let Some(us) = upscale {
+            plot_connected(r, &us.points, LINE_RED);
+        }
+        draw_border(r, BORDER_GREEN);
+        buf
+    }
+
+    #[test]
+    fn canvas_matches_from_scratch_rendering() {
+        let result = crate::analyze(&lanczos3, &crate::AnalysisConfig::default()).unwrap();
+        let (down, up) = (
+            result.downscale_curve.as_ref(),
+            result.upscale_curve.as_ref(),
+        );
+
+        let mut canvas = GraphCanvas::new();
+        let cases = [
+            (down, up, Some(KnownFilter::Lanczos3)),
+            (down, None, Some(KnownFilter::Lanczos3)),
+            (None, up, Some(KnownFilter::Mitchell)),
+            (down, up, None),
+            (None, None, None),
+        ];
+        for (d, u, reference) in cases {
+            let expected = render_from_scratch(d, u, reference);
+            assert_eq!(canvas.render(d, u, reference).buf(), &expected);
+            assert_eq!(render(d, u, reference).buf(), &expected);
+        }
+        let filter = KnownFilter::Lanczos3;
+        let with_kernel = canvas.render_with_kernel(down, up, Some(&filter));
+        assert_eq!(
+            with_kernel.buf(),
+            &render_from_scratch(down, up, Some(filter))
+        );
+    }
+
+    #[test]
+    fn render_into_a_strided_tile() {
+        let resize = |src: imgref::ImgRef<'_, u8>, w, h| {
+            crate::perfect_resize(src, w, h, KnownFilter::Mitchell)
+        };
+        let result = crate::analyze(&resize, &crate::AnalysisConfig::default()).unwrap();
+        let (down, up) = (
+            result.downscale_curve.as_ref(),
+            result.upscale_curve.as_ref(),
+        );
+        let expected = render_from_scratch(down, up, Some(KnownFilter::Mitchell));
+
+        // A 600x300 tile at (7, 3) of a wider sheet.
+        let stride = WIDTH + 20;
+        let mut sheet = ImgVec::new(vec![BLACK; stride * (HEIGHT + 6)], stride, HEIGHT + 6);
+        let mut canvas = GraphCanvas::new();
+        let before = canvas.image().buf().clone();
+        let mut tile = sheet.sub_image_mut(7, 3, WIDTH, HEIGHT);
+        canvas.render_into(&mut tile, down, up, Some(KnownFilter::Mitchell));
+
+        for (y, row) in sheet.rows().enumerate() {
+            for (x, &px) in row.iter().enumerate() {
+                let want = if (3..3 + HEIGHT).contains(&y) && (7..7 + WIDTH).contains(&x) {
+                    expected[(y - 3) * WIDTH + x - 7]
+                } else {
+                    BLACK
+                };
+                assert_eq!(px, want, "({x}, {y})");
+            }
+        }
+        assert_eq!(canvas.image().buf(), &before);
+    }
+
+    #[test]
+    fn svg_has_every_layer() {
+        let resize = |src: imgref::ImgRef<'_, u8>, w, h| {
+            crate::perfect_resize(src, w, h, KnownFilter::Mitchell)
+        };
+        let result = crate::analyze(&resize, &crate::AnalysisConfig::default()).unwrap();
+        let down = result.downscale_curve.as_ref().unwrap();
+        let svg = render_svg(
+            Some(down),
+            result.upscale_curve.as_ref(),
+            Some(KnownFilter::Mitchell),
+        );
+
+        assert!(svg.starts_with("<svg ") && svg.ends_with("</svg>\n"));
+        for color in [
+            GRID_GRAY,
+            BLACK,
+            REF_LIGHT,
+            SCATTER_BLUE,
+            LINE_RED,
+            BORDER_GREEN,
+        ] {
+            assert!(svg.contains(&hex(color)), "missing {}", hex(color));
+        }
+        assert!(svg.contains("stroke-dasharray"));
+
+        // One square per distinct scatter pixel: the blue pixels of the raster
+        // graph without the reference or line drawn over them.
+        let raster = render(Some(down), None, None);
+        let blue = raster.buf().iter().filter(|&&p| p == SCATTER_BLUE).count();
+        let squares = svg.matches("h1v1h-1z").count();
+        assert!(squares >= blue && squares < down.points.len() / 2);
+
+        let empty = render_svg(None, None, None);
+        assert!(!empty.contains(&hex(SCATTER_BLUE)));
+    }
+
+    #[test]
+    fn thumbnail_keeps_thin_lines() {
+        let result = crate::analyze(&lanczos3, &crate::AnalysisConfig::default()).unwrap();
+        let full = result.render_graph();
+        let thumb = thumbnail(full.as_ref(), 4);
+        assert_eq!((thumb.width(), thumb.height()), (WIDTH / 4, HEIGHT / 4));
+        assert!(thumb.buf().contains(&LINE_RED));
+        assert!(thumb.buf().contains(&BLACK));
+        // The axes cross at (230, 220).
+        assert_eq!(thumb.buf()[(220 / 4) * thumb.width() + 230 / 4], BLACK);
+        assert_eq!(thumbnail(full.as_ref(), 1).buf(), full.buf());
+    }
+
     #[test]
     fn coordinate_system() {
         assert_eq!(xcoord(0.0), 230);
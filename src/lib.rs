@@ -33,34 +33,96 @@
 //! implementations of these filters live in
 //! [imageflow](https://github.com/imazen/imageflow) by Imazen.
 
+pub mod adaptive;
 pub mod analyze;
+pub mod arena;
+pub mod async_probe;
+pub mod batch;
+pub mod bench;
+pub mod cache;
 pub mod edge;
 pub mod filters;
+pub mod fit;
 pub mod graph;
+pub mod multichannel;
+mod parallel;
 pub mod pattern;
+pub mod pixel;
+pub mod probe2d;
 pub mod reference;
 pub mod score;
+pub mod stream;
+pub mod suite;
+pub mod trace;
 
-use imgref::{ImgRef, ImgVec};
-use rgb::RGB8;
+use imgref::{ImgRef, ImgRefMut, ImgVec};
+use rgb::{RGB8, RGBA8};
 
-pub use analyze::FilterCurve;
+pub use adaptive::{AdaptiveConfig, AdaptiveResult, analyze_adaptive};
+pub use analyze::{CompactCurve, FilterCurve};
+pub use arena::{ProbeArena, analyze_into};
+pub use async_probe::{AsyncResizeFn, ResizeFuture, analyze_async};
+pub use batch::{BatchJob, BatchOutcome, analyze_batch};
+pub use bench::{BenchCase, BenchConfig, BenchReport, CaseTiming, bench_report, benchmark};
+pub use cache::{AnalysisCache, CacheEntry, CachedAnalysis};
 pub use edge::EdgeMode;
-pub use filters::KnownFilter;
-pub use reference::{PixelWeights, WeightEntry};
-pub use score::FilterScore;
+pub use filters::{FilterTable, Kernel, KnownFilter};
+pub use fit::{fit_cubic, fit_lanczos};
+pub use graph::GraphCanvas;
+pub use multichannel::{AlphaHandling, MultiChannelResult, analyze_rgb, analyze_rgba};
+pub use pattern::ProbeGeometry;
+pub use pixel::ProbePixel;
+pub use probe2d::{Analysis2D, Kernel2D, analyze_2d};
+pub use reference::{PixelWeights, ReferenceRows, WeightEntry, WeightTable};
+pub use score::{FilterScore, PreparedCurve};
+pub use stream::{DotStream, EdgeStream, LineStream};
+pub use suite::{SuiteOutcome, analyze_suite, scale_sweep};
+pub use trace::{Observer, Probe, Stage, StageTimings, analyze_observed, analyze_observed_as};
 
 /// The resize callback type: takes a grayscale source image and target dimensions,
 /// returns the resized grayscale image.
-pub type ResizeFn = dyn Fn(ImgRef<'_, u8>, usize, usize) -> ImgVec<u8>;
+pub type ResizeFn = ResizeFnOf<u8>;
+
+/// A resize callback in sample format `T` (see [`ProbePixel`]).
+pub type ResizeFnOf<T> = dyn Fn(ImgRef<'_, T>, usize, usize) -> ImgVec<T>;
+
+/// A resize callback that writes into a destination buffer owned by the crate
+/// (see [`analyze_into`]). The target dimensions are those of the destination.
+pub type ResizeIntoFn = ResizeIntoFnOf<u8>;
+
+/// A [`ResizeIntoFn`] in sample format `T`.
+pub type ResizeIntoFnOf<T> = dyn Fn(ImgRef<'_, T>, ImgRefMut<'_, T>);
+
+/// A [`ResizeFnOf`] for 16-bit samples, as taken by [`analyze_u16`].
+pub type ResizeFnU16 = ResizeFnOf<u16>;
+
+/// A [`ResizeFnOf`] for floating-point samples, as taken by [`analyze_f32`].
+pub type ResizeFnF32 = ResizeFnOf<f32>;
+
+/// An RGB resize callback, as taken by [`analyze_rgb`].
+pub type ResizeFnRgb = ResizeFnOf<RGB8>;
+
+/// An RGBA resize callback, as taken by [`analyze_rgba`]. Alpha is straight
+/// (not premultiplied) on input.
+pub type ResizeFnRgba = ResizeFnOf<RGBA8>;
+
+/// A [`ResizeFn`] that can be shared across threads, as required by [`analyze_batch`].
+pub type SyncResizeFn = dyn Fn(ImgRef<'_, u8>, usize, usize) -> ImgVec<u8> + Send + Sync;
 
 /// Configuration for analysis.
+///
+/// Non-exhaustive so new settings are not breaking changes: outside this crate,
+/// start from [`AnalysisConfig::default`] and adjust it with the `with_*`
+/// methods.
 #[derive(Debug, Clone)]
+#[non_exhaustive]
 pub struct AnalysisConfig {
     /// Whether the resizer operates in sRGB colorspace (converts to linear before resize).
     pub srgb: bool,
     /// Whether to detect edge handling mode.
     pub detect_edges: bool,
+    /// How many rows the line and edge probes ask the resizer for.
+    pub line_probe: LineProbe,
 }
 
 impl Default for AnalysisConfig {
@@ -68,10 +130,76 @@ impl Default for AnalysisConfig {
         Self {
             srgb: false,
             detect_edges: true,
+            line_probe: LineProbe::Full,
         }
     }
 }
 
+impl AnalysisConfig {
+    /// Set [`srgb`](Self::srgb).
+    pub fn with_srgb(mut self, srgb: bool) -> Self {
+        self.srgb = srgb;
+        self
+    }
+
+    /// Set [`detect_edges`](Self::detect_edges).
+    pub fn with_detect_edges(mut self, detect_edges: bool) -> Self {
+        self.detect_edges = detect_edges;
+        self
+    }
+
+    /// Set [`line_probe`](Self::line_probe).
+    pub fn with_line_probe(mut self, line_probe: LineProbe) -> Self {
+        self.line_probe = line_probe;
+        self
+    }
+}
+
+/// Height of the line and edge probes.
+///
+/// Line analysis only reads the middle scanline and its two neighbors, and
+/// edge detection only the middle scanline, so the other rows of the full
+/// probe are pure cost for an expensive resizer. Every row of those patterns
+/// is identical and the vertical axis is never scaled, so a resizer that keeps
+/// a uniform column uniform produces the same middle rows from a cropped probe.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum LineProbe {
+    /// The full 15x15 -> 555x15 probe of the original tool.
+    #[default]
+    Full,
+    /// The middle three rows only (15x3 -> 555x3): exactly the rows the
+    /// analysis reads.
+    Minimal,
+    /// A single row (15x1 -> 555x1). The resizer must accept one-row images and
+    /// treat the unscaled vertical axis as identity. The line analysis then
+    /// reads every column from that row, so the C tool's ±1-row consistency
+    /// check is lost.
+    SingleRow,
+}
+
+impl LineProbe {
+    /// Number of rows in the probe pattern and its resize target.
+    pub fn rows(self) -> usize {
+        match self {
+            Self::Full => pattern::LINE_SRC_HEIGHT,
+            Self::Minimal => 3,
+            Self::SingleRow => 1,
+        }
+    }
+
+    /// The middle [`rows`](Self::rows) rows of a full line or edge pattern.
+    pub fn crop<T>(self, full: ImgRef<'_, T>) -> ImgRef<'_, T> {
+        let rows = self.rows().min(full.height());
+        let top = (full.height() - rows) / 2;
+        full.sub_image(0, top, full.width(), rows)
+    }
+
+    /// Target dimensions of the line and edge probe resizes.
+    pub fn target(self) -> (usize, usize) {
+        (pattern::LINE_DST_WIDTH, self.rows())
+    }
+}
+
 /// Complete analysis result from probing a resizer.
 #[derive(Debug, Clone)]
 pub struct AnalysisResult {
@@ -108,10 +236,80 @@ impl AnalysisResult {
             Some(filter),
         )
     }
+
+    /// [`render_graph`](Self::render_graph) as an SVG document; see
+    /// [`graph::render_svg`].
+    pub fn render_svg(&self) -> String {
+        graph::render_svg(
+            self.downscale_curve.as_ref(),
+            self.upscale_curve.as_ref(),
+            None,
+        )
+    }
+
+    /// [`render_graph_with_reference`](Self::render_graph_with_reference) as an
+    /// SVG document.
+    pub fn render_svg_with_reference(&self, filter: KnownFilter) -> String {
+        graph::render_svg(
+            self.downscale_curve.as_ref(),
+            self.upscale_curve.as_ref(),
+            Some(filter),
+        )
+    }
+
+    /// Drop the raw curves, keeping [`FilterCurve::compact`] versions of them
+    /// alongside the scores.
+    pub fn into_compact(self) -> CompactResult {
+        CompactResult {
+            downscale_curve: self.downscale_curve.as_ref().map(FilterCurve::compact),
+            upscale_curve: self.upscale_curve.as_ref().map(FilterCurve::compact),
+            scores: self.scores,
+            edge_mode: self.edge_mode,
+        }
+    }
+}
+
+/// An [`AnalysisResult`] with its curves in [`CompactCurve`] form, as
+/// returned by [`analyze_compact`].
+#[derive(Debug, Clone)]
+pub struct CompactResult {
+    /// Binned downscale curve.
+    pub downscale_curve: Option<CompactCurve>,
+    /// Upscale curve in `f32`.
+    pub upscale_curve: Option<CompactCurve>,
+    /// Scores against known reference filters, sorted best-first by correlation.
+    pub scores: Vec<FilterScore>,
+    /// Detected edge handling mode, if requested.
+    pub edge_mode: Option<EdgeMode>,
+}
+
+impl CompactResult {
+    /// Returns the best-matching filter if correlation exceeds 0.99.
+    pub fn best_match(&self) -> Option<&FilterScore> {
+        self.scores.first().filter(|s| s.correlation > 0.99)
+    }
+
+    /// Render a scope graph of the compact curve(s).
+    pub fn render_graph(&self) -> ImgVec<RGB8> {
+        graph::render(
+            self.downscale_curve
+                .as_ref()
+                .map(CompactCurve::to_curve)
+                .as_ref(),
+            self.upscale_curve
+                .as_ref()
+                .map(CompactCurve::to_curve)
+                .as_ref(),
+            None,
+        )
+    }
 }
 
 /// Error type for analysis operations.
+///
+/// Non-exhaustive: match it with a wildcard arm.
 #[derive(Debug, thiserror::Error)]
+#[non_exhaustive]
 pub enum Error {
     #[error(
         "resize callback returned wrong dimensions: expected {expected_w}x{expected_h}, got {actual_w}x{actual_h}"
@@ -124,9 +322,13 @@ pub enum Error {
     },
     #[error("analysis produced no usable data")]
     NoData,
+    #[error("cached analysis data is corrupt: {0}")]
+    CorruptCache(&'static str),
+    #[error("invalid probe geometry: {0}")]
+    InvalidGeometry(&'static str),
 }
 
-fn check_dimensions(img: &ImgVec<u8>, expected_w: usize, expected_h: usize) -> Result<(), Error> {
+fn check_dimensions<T>(img: &ImgVec<T>, expected_w: usize, expected_h: usize) -> Result<(), Error> {
     if img.width() != expected_w || img.height() != expected_h {
         return Err(Error::WrongDimensions {
             expected_w,
@@ -138,25 +340,38 @@ fn check_dimensions(img: &ImgVec<u8>, expected_w: usize, expected_h: usize) -> R
     Ok(())
 }
 
-/// Run both downscale and upscale analysis, score against known filters,
-/// and optionally detect edge handling.
-pub fn analyze(resize: &ResizeFn, config: &AnalysisConfig) -> Result<AnalysisResult, Error> {
-    // Downscale analysis (dot pattern).
-    let dot_src = pattern::generate_dot_pattern();
+/// Resize the dot pattern and reconstruct the downscale curve from it.
+pub(crate) fn probe_dot<T: ProbePixel>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+) -> Result<FilterCurve, Error> {
     let (dot_w, dot_h) = analyze::dot_target();
-    let dot_resized = resize(dot_src.as_ref(), dot_w, dot_h);
+    let dot_resized = resize(T::patterns().dot.as_ref(), dot_w, dot_h);
     check_dimensions(&dot_resized, dot_w, dot_h)?;
-    let downscale_curve = analyze::analyze_dot(&dot_resized.as_ref(), config.srgb);
+    Ok(analyze::analyze_dot(&dot_resized.as_ref(), config.srgb))
+}
 
-    // Upscale analysis (line pattern).
-    let line_src = pattern::generate_line_pattern();
-    let (line_w, line_h) = analyze::line_target();
-    let line_resized = resize(line_src.as_ref(), line_w, line_h);
+/// Resize the line pattern and reconstruct the upscale curve from it.
+pub(crate) fn probe_line<T: ProbePixel>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+) -> Result<FilterCurve, Error> {
+    let (line_w, line_h) = config.line_probe.target();
+    let line_pattern = config.line_probe.crop(T::patterns().line.as_ref());
+    let line_resized = resize(line_pattern, line_w, line_h);
     check_dimensions(&line_resized, line_w, line_h)?;
-    let upscale_curve = analyze::analyze_line(&line_resized.as_ref(), config.srgb);
+    Ok(analyze::analyze_line(&line_resized.as_ref(), config.srgb))
+}
 
-    // Score using the upscale curve (higher resolution, cleaner data).
-    // Fall back to downscale if upscale has no points.
+/// Score the probed curves and assemble the result of a full [`analyze`] run.
+///
+/// Scores the upscale curve (higher resolution, cleaner data), falling back to
+/// the downscale curve when the upscale curve has no points.
+pub(crate) fn assemble_result(
+    downscale_curve: FilterCurve,
+    upscale_curve: FilterCurve,
+    edge_mode: Option<EdgeMode>,
+) -> Result<AnalysisResult, Error> {
     let scoring_curve = if !upscale_curve.points.is_empty() {
         &upscale_curve
     } else if !downscale_curve.points.is_empty() {
@@ -167,13 +382,6 @@ pub fn analyze(resize: &ResizeFn, config: &AnalysisConfig) -> Result<AnalysisRes
 
     let scores = score::score_against_all(scoring_curve);
 
-    // Edge detection.
-    let edge_mode = if config.detect_edges {
-        Some(edge::detect(resize))
-    } else {
-        None
-    };
-
     Ok(AnalysisResult {
         downscale_curve: Some(downscale_curve),
         upscale_curve: Some(upscale_curve),
@@ -182,16 +390,58 @@ pub fn analyze(resize: &ResizeFn, config: &AnalysisConfig) -> Result<AnalysisRes
     })
 }
 
+/// Run both downscale and upscale analysis, score against known filters,
+/// and optionally detect edge handling.
+pub fn analyze(resize: &ResizeFn, config: &AnalysisConfig) -> Result<AnalysisResult, Error> {
+    analyze_as::<u8>(resize, config)
+}
+
+/// [`analyze`](fn@analyze), keeping only the compact curves: the raw scatter
+/// is dropped as soon as it has been scored. See [`AnalysisResult::into_compact`].
+pub fn analyze_compact(resize: &ResizeFn, config: &AnalysisConfig) -> Result<CompactResult, Error> {
+    analyze(resize, config).map(AnalysisResult::into_compact)
+}
+
+/// [`analyze`](fn@analyze) for a resizer that works on 16-bit samples.
+///
+/// The probes are fed and read back at full 16-bit precision, so the curves
+/// are not quantized to the 200 levels between DARK and BRIGHT.
+pub fn analyze_u16(resize: &ResizeFnU16, config: &AnalysisConfig) -> Result<AnalysisResult, Error> {
+    analyze_as::<u16>(resize, config)
+}
+
+/// [`analyze`](fn@analyze) for a resizer that works on floating-point samples in `0.0..=1.0`.
+///
+/// The probes are fed and read back without any 8-bit conversion, so the
+/// curves are not quantized and ringing outside the nominal range is kept.
+pub fn analyze_f32(resize: &ResizeFnF32, config: &AnalysisConfig) -> Result<AnalysisResult, Error> {
+    analyze_as::<f32>(resize, config)
+}
+
+/// [`analyze`](fn@analyze) for a resizer in any [`ProbePixel`] format.
+pub fn analyze_as<T: ProbePixel>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+) -> Result<AnalysisResult, Error> {
+    // The observed driver with an observer that ignores everything, so the
+    // two paths cannot drift apart.
+    trace::analyze_observed_as(resize, config, &mut trace::NoObserver)
+}
+
 /// Run only the downscale analysis (dot pattern, 557->555).
 pub fn analyze_downscale(
     resize: &ResizeFn,
     config: &AnalysisConfig,
 ) -> Result<AnalysisResult, Error> {
-    let dot_src = pattern::generate_dot_pattern();
-    let (dot_w, dot_h) = analyze::dot_target();
-    let dot_resized = resize(dot_src.as_ref(), dot_w, dot_h);
-    check_dimensions(&dot_resized, dot_w, dot_h)?;
-    let downscale_curve = analyze::analyze_dot(&dot_resized.as_ref(), config.srgb);
+    analyze_downscale_as::<u8>(resize, config)
+}
+
+/// [`analyze_downscale`] for a resizer in any [`ProbePixel`] format.
+pub fn analyze_downscale_as<T: ProbePixel>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+) -> Result<AnalysisResult, Error> {
+    let downscale_curve = probe_dot(resize, config)?;
 
     if downscale_curve.points.is_empty() {
         return Err(Error::NoData);
@@ -212,11 +462,15 @@ pub fn analyze_upscale(
     resize: &ResizeFn,
     config: &AnalysisConfig,
 ) -> Result<AnalysisResult, Error> {
-    let line_src = pattern::generate_line_pattern();
-    let (line_w, line_h) = analyze::line_target();
-    let line_resized = resize(line_src.as_ref(), line_w, line_h);
-    check_dimensions(&line_resized, line_w, line_h)?;
-    let upscale_curve = analyze::analyze_line(&line_resized.as_ref(), config.srgb);
+    analyze_upscale_as::<u8>(resize, config)
+}
+
+/// [`analyze_upscale`] for a resizer in any [`ProbePixel`] format.
+pub fn analyze_upscale_as<T: ProbePixel>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+) -> Result<AnalysisResult, Error> {
+    let upscale_curve = probe_line(resize, config)?;
 
     if upscale_curve.points.is_empty() {
         return Err(Error::NoData);
@@ -225,7 +479,7 @@ pub fn analyze_upscale(
     let scores = score::score_against_all(&upscale_curve);
 
     let edge_mode = if config.detect_edges {
-        Some(edge::detect(resize))
+        Some(edge::detect_with(resize, config.line_probe))
     } else {
         None
     };
@@ -239,10 +493,44 @@ pub fn analyze_upscale(
 }
 
 // Re-export convenience functions from pattern.
-pub use pattern::{generate_dot_pattern, generate_line_pattern};
+pub use pattern::{
+    dot_pattern, generate_dot_pattern, generate_line_pattern, line_pattern, patterns,
+};
 
 // Re-export reference resize functions.
-pub use reference::{compute_weights, perfect_resize};
+pub use reference::{
+    compute_weight_table, compute_weights, perfect_resize, perfect_resize_fast,
+    perfect_resize_parallel, perfect_resize_with_kernel,
+};
 
 // Re-export SSIM.
-pub use score::ssim;
+pub use score::{SSIM_WINDOW, ssim, ssim_against_kernel, ssim_against_reference, ssim_windowed};
+
+/// Resize callbacks shared by the unit tests.
+#[cfg(test)]
+pub(crate) mod test_util {
+    use std::ops::Deref;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    use imgref::{ImgRef, ImgVec};
+
+    use crate::{KnownFilter, perfect_resize};
+
+    /// The reference Lanczos3 resize.
+    pub(crate) fn lanczos3(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        perfect_resize(src, w, h, KnownFilter::Lanczos3)
+    }
+
+    /// `resize`, adding one to `calls` on every call. Each test passes a
+    /// counter of its own (an `Arc`, or a `&'static`), so tests running in
+    /// parallel don't see each other's calls.
+    pub(crate) fn counted<T: 'static>(
+        calls: impl Deref<Target = AtomicU64> + 'static,
+        resize: impl Fn(ImgRef<'_, T>, usize, usize) -> ImgVec<T> + 'static,
+    ) -> impl Fn(ImgRef<'_, T>, usize, usize) -> ImgVec<T> + 'static {
+        move |src, w, h| {
+            calls.fetch_add(1, Ordering::Relaxed);
+            resize(src, w, h)
+        }
+    }
+}
@@ -0,0 +1,425 @@
+//! Probing RGB and RGBA resizers with several probes packed into the channels.
+//!
+//! A color resizer driven through a grayscale [`ResizeFn`](crate::ResizeFn)
+//! wrapper resizes three identical channels and throws two away. The line and
+//! edge probes share one geometry (15 -> 555), so here they travel in
+//! separate channels of a single image: line in red, edge in green, and, for
+//! RGBA, an alpha probe in blue and alpha that shows whether the resizer
+//! premultiplies. The dot probe needs its own ratio (557 -> 555) and is a
+//! second call, so a full analysis takes two resizes instead of three.
+//!
+//! A premultiplying resizer zeroes every channel where alpha is 0, so the alpha
+//! probe only occupies the top [`ALPHA_ROWS`] rows. The line and edge analyses
+//! read the middle rows, out of reach of any vertical kernel at the probe's
+//! unscaled 1:1 height.
+
+use std::sync::OnceLock;
+
+use imgref::ImgVec;
+use rgb::{RGB8, RGBA8};
+
+use crate::analyze;
+use crate::edge;
+use crate::pattern::{self, BRIGHT, DARK, LINE_SRC_HEIGHT, LINE_SRC_WIDTH};
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFnRgb, ResizeFnRgba};
+
+/// How a resizer treats the color of partially transparent pixels, as seen
+/// by the alpha probe of [`analyze_rgba`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum AlphaHandling {
+    /// Channels are filtered independently, so color from fully transparent
+    /// pixels bleeds into visible ones.
+    Straight,
+    /// Color is weighted by alpha and divided back out afterwards: transparent
+    /// pixels contribute nothing.
+    Premultiplied,
+    /// Color is weighted by alpha and left that way: the output is
+    /// premultiplied.
+    PremultipliedOutput,
+    /// No partially transparent output pixels, or none of the models fit.
+    Unknown,
+}
+
+impl std::fmt::Display for AlphaHandling {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::Straight => f.write_str("Straight"),
+            Self::Premultiplied => f.write_str("Premultiplied"),
+            Self::PremultipliedOutput => f.write_str("PremultipliedOutput"),
+            Self::Unknown => f.write_str("Unknown"),
+        }
+    }
+}
+
+/// Result of [`analyze_rgb`] or [`analyze_rgba`].
+#[derive(Debug, Clone)]
+pub struct MultiChannelResult {
+    /// The same analysis [`analyze`](fn@crate::analyze) produces, from the
+    /// packed channels.
+    pub analysis: AnalysisResult,
+    /// The alpha probe's verdict; `None` for RGB or a cropped line probe.
+    pub alpha: Option<AlphaHandling>,
+}
+
+/// Columns at or left of this are opaque in the alpha probe; the rest are
+/// transparent.
+const ALPHA_EDGE: usize = LINE_SRC_WIDTH / 2;
+
+/// Rows at the top of the line call that carry the alpha probe. All other
+/// rows are opaque.
+pub const ALPHA_ROWS: usize = 3;
+
+/// Mean error (in 8-bit levels) above which no alpha model is accepted.
+const ALPHA_TOLERANCE: f64 = 24.0;
+
+/// A packed color format. Channel 0 carries the line probe (or the dot probe),
+/// channel 1 the edge probe, and RGBA adds the alpha probe in blue and alpha.
+trait PackedPixel: Copy + 'static {
+    fn pack(line: u8, edge: u8, alpha_color: u8, alpha: u8) -> Self;
+    fn channel(self, i: usize) -> u8;
+    fn patterns() -> &'static PackedPatterns<Self>;
+}
+
+impl PackedPixel for RGB8 {
+    fn pack(line: u8, edge: u8, _alpha_color: u8, _alpha: u8) -> Self {
+        RGB8 {
+            r: line,
+            g: edge,
+            b: DARK,
+        }
+    }
+
+    fn channel(self, i: usize) -> u8 {
+        [self.r, self.g, self.b][i]
+    }
+
+    fn patterns() -> &'static PackedPatterns<Self> {
+        static PATTERNS: OnceLock<PackedPatterns<RGB8>> = OnceLock::new();
+        PATTERNS.get_or_init(PackedPatterns::generate)
+    }
+}
+
+impl PackedPixel for RGBA8 {
+    fn pack(line: u8, edge: u8, alpha_color: u8, alpha: u8) -> Self {
+        RGBA8 {
+            r: line,
+            g: edge,
+            b: alpha_color,
+            a: alpha,
+        }
+    }
+
+    fn channel(self, i: usize) -> u8 {
+        [self.r, self.g, self.b, self.a][i]
+    }
+
+    fn patterns() -> &'static PackedPatterns<Self> {
+        static PATTERNS: OnceLock<PackedPatterns<RGBA8>> = OnceLock::new();
+        PATTERNS.get_or_init(PackedPatterns::generate)
+    }
+}
+
+/// The two packed source images.
+struct PackedPatterns<P> {
+    /// The dot pattern in every color channel, fully opaque.
+    dot: ImgVec<P>,
+    /// Line, edge and alpha probes, 15x15.
+    line: ImgVec<P>,
+}
+
+impl<P: PackedPixel> PackedPatterns<P> {
+    fn generate() -> Self {
+        let patterns = pattern::patterns();
+        let dot = patterns.dot.buf().iter().map(|&v| P::pack(v, v, v, 255));
+        let mut line = Vec::with_capacity(LINE_SRC_WIDTH * LINE_SRC_HEIGHT);
+        for (y, (l, e)) in patterns.line.rows().zip(patterns.edge.rows()).enumerate() {
+            for (x, (&l, &e)) in l[..LINE_SRC_WIDTH].iter().zip(e).enumerate() {
+                let (color, alpha) = if y >= ALPHA_ROWS || x <= ALPHA_EDGE {
+                    (DARK, 255)
+                } else {
+                    (BRIGHT, 0)
+                };
+                line.push(P::pack(l, e, color, alpha));
+            }
+        }
+        Self {
+            dot: ImgVec::new(dot.collect(), patterns.dot.width(), patterns.dot.height()),
+            line: ImgVec::new(line, LINE_SRC_WIDTH, LINE_SRC_HEIGHT),
+        }
+    }
+}
+
+fn extract<P: PackedPixel>(img: &ImgVec<P>, channel: usize) -> ImgVec<u8> {
+    let w = img.width();
+    let buf = img
+        .rows()
+        .flat_map(|row| row[..w].iter().map(move |&p| p.channel(channel)))
+        .collect();
+    ImgVec::new(buf, w, img.height())
+}
+
+/// Classify alpha handling from the color (`colors`) and alpha (`alphas`) of
+/// the middle output row of the alpha probe.
+///
+/// Compares every partially transparent pixel with the color each model
+/// predicts. In the source, color is `DARK + (BRIGHT - DARK) * (1 - alpha)`
+/// and premultiplied color is `DARK * alpha`, both linear in alpha, so
+/// whatever the kernel: straight filtering keeps the first relation,
+/// premultiply-and-divide stays at DARK, and premultiplied output follows
+/// the second.
+fn classify_alpha(colors: &[u8], alphas: &[u8]) -> AlphaHandling {
+    let models = [
+        AlphaHandling::Straight,
+        AlphaHandling::Premultiplied,
+        AlphaHandling::PremultipliedOutput,
+    ];
+    let (dark, bright) = (DARK as f64, BRIGHT as f64);
+    let mut errors = [0.0_f64; 3];
+    let mut count = 0;
+    for (&c, &a) in colors.iter().zip(alphas) {
+        if !(16..=239).contains(&a) {
+            continue;
+        }
+        let coverage = a as f64 / 255.0;
+        let predicted = [
+            dark + (bright - dark) * (1.0 - coverage),
+            dark,
+            dark * coverage,
+        ];
+        for (err, p) in errors.iter_mut().zip(predicted) {
+            *err += (c as f64 - p).abs();
+        }
+        count += 1;
+    }
+    if count == 0 {
+        return AlphaHandling::Unknown;
+    }
+    let (best, err) = models
+        .into_iter()
+        .zip(errors.map(|e| e / count as f64))
+        .min_by(|a, b| a.1.total_cmp(&b.1))
+        .expect("three models");
+    if err > ALPHA_TOLERANCE {
+        AlphaHandling::Unknown
+    } else {
+        best
+    }
+}
+
+fn analyze_packed<P: PackedPixel>(
+    resize: &crate::ResizeFnOf<P>,
+    config: &AnalysisConfig,
+    has_alpha: bool,
+) -> Result<MultiChannelResult, Error> {
+    let patterns = P::patterns();
+
+    let (dot_w, dot_h) = analyze::dot_target();
+    let dot = resize(patterns.dot.as_ref(), dot_w, dot_h);
+    crate::check_dimensions(&dot, dot_w, dot_h)?;
+    let downscale_curve = analyze::analyze_dot(&extract(&dot, 0).as_ref(), config.srgb);
+
+    let (line_w, line_h) = config.line_probe.target();
+    let line = resize(
+        config.line_probe.crop(patterns.line.as_ref()),
+        line_w,
+        line_h,
+    );
+    crate::check_dimensions(&line, line_w, line_h)?;
+    let upscale_curve = analyze::analyze_line(&extract(&line, 0).as_ref(), config.srgb);
+    let edge_mode = config
+        .detect_edges
+        .then(|| edge::classify(extract(&line, 1).as_ref()));
+    // Cropped line probes leave out the alpha rows.
+    let alpha = (has_alpha && line_h == LINE_SRC_HEIGHT).then(|| {
+        let middle: &[P] = &line.buf()[(ALPHA_ROWS / 2) * line.stride()..][..line_w];
+        let colors: Vec<u8> = middle.iter().map(|p| p.channel(2)).collect();
+        let alphas: Vec<u8> = middle.iter().map(|p| p.channel(3)).collect();
+        classify_alpha(&colors, &alphas)
+    });
+
+    Ok(MultiChannelResult {
+        analysis: crate::assemble_result(downscale_curve, upscale_curve, edge_mode)?,
+        alpha,
+    })
+}
+
+/// [`analyze`](fn@crate::analyze) an RGB resizer in two calls: the dot probe,
+/// then the line (red) and edge (green) probes together.
+pub fn analyze_rgb(
+    resize: &ResizeFnRgb,
+    config: &AnalysisConfig,
+) -> Result<MultiChannelResult, Error> {
+    analyze_packed(resize, config, false)
+}
+
+/// [`analyze_rgb`] for an RGBA resizer, with the alpha probe (blue and alpha)
+/// riding along in the line call to detect premultiplication.
+///
+/// The alpha probe needs the full-height line call; with a shorter
+/// [`LineProbe`](crate::LineProbe) `alpha` is `None`.
+pub fn analyze_rgba(
+    resize: &ResizeFnRgba,
+    config: &AnalysisConfig,
+) -> Result<MultiChannelResult, Error> {
+    analyze_packed(resize, config, true)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::test_util::{counted, lanczos3};
+    use crate::{KnownFilter, perfect_resize};
+    use imgref::ImgRef;
+    use std::sync::Arc;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    fn resize_channels(
+        src: ImgRef<'_, RGBA8>,
+        w: usize,
+        h: usize,
+        premultiply: bool,
+    ) -> Vec<[u8; 4]> {
+        let plane = |f: &dyn Fn(RGBA8) -> u8| {
+            let buf = src
+                .rows()
+                .flat_map(|r| r[..src.width()].iter().map(|&p| f(p)))
+                .collect();
+            perfect_resize(
+                ImgVec::new(buf, src.width(), src.height()).as_ref(),
+                w,
+                h,
+                KnownFilter::Lanczos3,
+            )
+        };
+        let scale = |v: u8, a: u8| (v as u32 * a as u32 / 255) as u8;
+        let (r, g, b, a) = if premultiply {
+            (
+                plane(&|p| scale(p.r, p.a)),
+                plane(&|p| scale(p.g, p.a)),
+                plane(&|p| scale(p.b, p.a)),
+                plane(&|p| p.a),
+            )
+        } else {
+            (
+                plane(&|p| p.r),
+                plane(&|p| p.g),
+                plane(&|p| p.b),
+                plane(&|p| p.a),
+            )
+        };
+        (0..w * h)
+            .map(|i| [r.buf()[i], g.buf()[i], b.buf()[i], a.buf()[i]])
+            .collect()
+    }
+
+    fn straight(src: ImgRef<'_, RGBA8>, w: usize, h: usize) -> ImgVec<RGBA8> {
+        let px = resize_channels(src, w, h, false);
+        ImgVec::new(
+            px.into_iter()
+                .map(|[r, g, b, a]| RGBA8 { r, g, b, a })
+                .collect(),
+            w,
+            h,
+        )
+    }
+
+    fn premultiplied(src: ImgRef<'_, RGBA8>, w: usize, h: usize) -> ImgVec<RGBA8> {
+        let unscale = |v: u8, a: u8| {
+            if a == 0 {
+                0
+            } else {
+                (v as u32 * 255 / a as u32).min(255) as u8
+            }
+        };
+        let px = resize_channels(src, w, h, true);
+        let out = px.into_iter().map(|[r, g, b, a]| RGBA8 {
+            r: unscale(r, a),
+            g: unscale(g, a),
+            b: unscale(b, a),
+            a,
+        });
+        ImgVec::new(out.collect(), w, h)
+    }
+
+    fn premultiplied_output(src: ImgRef<'_, RGBA8>, w: usize, h: usize) -> ImgVec<RGBA8> {
+        let px = resize_channels(src, w, h, true);
+        ImgVec::new(
+            px.into_iter()
+                .map(|[r, g, b, a]| RGBA8 { r, g, b, a })
+                .collect(),
+            w,
+            h,
+        )
+    }
+
+    #[test]
+    fn rgba_matches_grayscale_in_two_calls() {
+        let config = AnalysisConfig::default();
+        let calls = Arc::new(AtomicU64::new(0));
+        let packed = analyze_rgba(&counted(Arc::clone(&calls), straight), &config).unwrap();
+        assert_eq!(calls.load(Ordering::Relaxed), 2);
+
+        let gray = crate::analyze(&lanczos3, &config).unwrap();
+        assert_eq!(packed.analysis.scores[0].filter, gray.scores[0].filter);
+        assert_eq!(
+            packed.analysis.scores[0].correlation,
+            gray.scores[0].correlation
+        );
+        assert_eq!(packed.analysis.edge_mode, gray.edge_mode);
+        assert_eq!(packed.alpha, Some(AlphaHandling::Straight));
+    }
+
+    #[test]
+    fn detects_premultiplication() {
+        let config = AnalysisConfig::default();
+        let pre = analyze_rgba(&premultiplied, &config).unwrap();
+        assert_eq!(pre.alpha, Some(AlphaHandling::Premultiplied));
+        let out = analyze_rgba(&premultiplied_output, &config).unwrap();
+        assert_eq!(out.alpha, Some(AlphaHandling::PremultipliedOutput));
+        // The line and edge rows are opaque, so premultiplying does not disturb
+        // them.
+        assert_eq!(
+            pre.analysis.best_match().unwrap().filter,
+            KnownFilter::Lanczos3
+        );
+        let plain = analyze_rgba(&straight, &config).unwrap();
+        assert_eq!(pre.analysis.edge_mode, plain.analysis.edge_mode);
+
+        let cropped = AnalysisConfig {
+            line_probe: crate::LineProbe::Minimal,
+            ..Default::default()
+        };
+        assert!(
+            analyze_rgba(&premultiplied, &cropped)
+                .unwrap()
+                .alpha
+                .is_none()
+        );
+    }
+
+    #[test]
+    fn rgb_has_no_alpha_verdict() {
+        fn rgb_resize(src: ImgRef<'_, RGB8>, w: usize, h: usize) -> ImgVec<RGB8> {
+            let rgba: Vec<RGBA8> = src
+                .rows()
+                .flat_map(|r| r[..src.width()].iter())
+                .map(|p| RGBA8 {
+                    r: p.r,
+                    g: p.g,
+                    b: p.b,
+                    a: 255,
+                })
+                .collect();
+            let rgba = ImgVec::new(rgba, src.width(), src.height());
+            let out = resize_channels(rgba.as_ref(), w, h, false);
+            let px = out.into_iter().map(|[r, g, b, _]| RGB8 { r, g, b });
+            ImgVec::new(px.collect(), w, h)
+        }
+        let result = analyze_rgb(&rgb_resize, &AnalysisConfig::default()).unwrap();
+        assert!(result.alpha.is_none());
+        assert_eq!(
+            result.analysis.best_match().unwrap().filter,
+            KnownFilter::Lanczos3
+        );
+    }
+}
@@ -0,0 +1,129 @@
+//! Minimal scoped worker pool shared by the batch and parallel entry points.
+
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// Number of worker threads to use for `tasks` independent work items.
+///
+/// `requested` caps the pool; `None` uses the available parallelism. Never
+/// returns more workers than tasks, and always at least one.
+pub(crate) fn worker_count(requested: Option<usize>, tasks: usize) -> usize {
+    let available = requested.unwrap_or_else(|| {
+        std::thread::available_parallelism()
+            .map(|n| n.get())
+            .unwrap_or(1)
+    });
+    available.clamp(1, tasks.max(1))
+}
+
+/// Evaluate `f(i)` for every `i in 0..n` on up to `threads` scoped workers.
+///
+/// Workers pull indices from a shared counter, so uneven task costs balance
+/// out. Results are returned in index order. A panic in `f` is propagated to
+/// the caller once all workers have stopped.
+pub(crate) fn map_indexed<T, F>(n: usize, threads: usize, f: F) -> Vec<T>
+where
+    T: Send,
+    F: Fn(usize) -> T + Sync,
+{
+    if threads <= 1 || n <= 1 {
+        return (0..n).map(f).collect();
+    }
+
+    let next = AtomicUsize::new(0);
+    let mut results: Vec<Option<T>> = (0..n).map(|_| None).collect();
+
+    std::thread::scope(|s| {
+        let workers: Vec<_> = (0..threads.min(n))
+            .map(|_| {
+                s.spawn(|| {
+                    let mut done = Vec::new();
+                    loop {
+                        let i = next.fetch_add(1, Ordering::Relaxed);
+                        if i >= n {
+                            break;
+                        }
+                        done.push((i, f(i)));
+                    }
+                    done
+                })
+            })
+            .collect();
+
+        for worker in workers {
+            match worker.join() {
+                Ok(done) => {
+                    for (i, value) in done {
+                        results[i] = Some(value);
+                    }
+                }
+                Err(panic) => std::panic::resume_unwind(panic),
+            }
+        }
+    });
+
+    results
+        .into_iter()
+        .map(|r| r.expect("every index is claimed by exactly one worker"))
+        .collect()
+}
+
+/// Call `f(i, chunk)` for every `chunk_len`-sized chunk of `buf` (the last may
+/// be shorter), splitting the chunks into up to `threads` contiguous bands that
+/// run on scoped workers. `i` is the chunk's index within `buf`.
+pub(crate) fn for_each_chunk_mut<T, F>(buf: &mut [T], chunk_len: usize, threads: usize, f: F)
+where
+    T: Send,
+    F: Fn(usize, &mut [T]) + Sync,
+{
+    let chunk_len = chunk_len.max(1);
+    let chunks = buf.len().div_ceil(chunk_len);
+    if threads <= 1 || chunks <= 1 {
+        for (i, chunk) in buf.chunks_mut(chunk_len).enumerate() {
+            f(i, chunk);
+        }
+        return;
+    }
+
+    let per_band = chunks.div_ceil(threads);
+    std::thread::scope(|s| {
+        for (band, band_buf) in buf.chunks_mut(per_band * chunk_len).enumerate() {
+            let f = &f;
+            s.spawn(move || {
+                for (j, chunk) in band_buf.chunks_mut(chunk_len).enumerate() {
+                    f(band * per_band + j, chunk);
+                }
+            });
+        }
+    });
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn map_indexed_preserves_order() {
+        let out = map_indexed(100, 4, |i| i * i);
+        assert_eq!(out, (0..100).map(|i| i * i).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn for_each_chunk_mut_visits_every_chunk() {
+        let mut buf = vec![0usize; 103];
+        for_each_chunk_mut(&mut buf, 10, 4, |i, chunk| {
+            for v in chunk {
+                *v = i;
+            }
+        });
+        for (k, &v) in buf.iter().enumerate() {
+            assert_eq!(v, k / 10);
+        }
+    }
+
+    #[test]
+    fn worker_count_bounds() {
+        assert_eq!(worker_count(Some(8), 3), 3);
+        assert_eq!(worker_count(Some(0), 3), 1);
+        assert_eq!(worker_count(Some(2), 0), 1);
+    }
+}
@@ -1,4 +1,10 @@
-use imgref::ImgVec;
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex, OnceLock};
+
+use imgref::{ImgRef, ImgVec};
+
+use crate::Error;
+use crate::pixel::ProbePixel;
 
 // Dot pattern constants (matching C source exactly)
 pub const DOT_SRC_WIDTH: usize = 557;
@@ -21,12 +27,200 @@ pub const LINE_DST_HEIGHT: usize = LINE_SRC_HEIGHT; // 15
 pub const DARK: u8 = 50;
 pub const BRIGHT: u8 = 250;
 
+/// The sizes of the dot and line probes: how wide their patterns are and what
+/// width they are resized to. The default is the original tool's geometry (the
+/// constants above); [`ProbeGeometry::at_scale`] builds one for any ratio.
+///
+/// Only the horizontal axis is ever scaled; the pattern heights are fixed by
+/// the strip layout (dot) and [`LINE_SRC_HEIGHT`] (line).
+///
+/// The fields are public so a geometry can be written out by hand; functions
+/// that take one check it with [`validate`](Self::validate).
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ProbeGeometry {
+    /// Horizontal distance between dots, which is also the number of strips.
+    /// Must be odd so the dot sits in the middle of its span.
+    pub dot_span: usize,
+    /// Width of the dot pattern.
+    pub dot_src_width: usize,
+    /// Width the dot pattern is resized to.
+    pub dot_dst_width: usize,
+    /// Width of the line pattern.
+    pub line_src_width: usize,
+    /// Width the line pattern is resized to.
+    pub line_dst_width: usize,
+}
+
+impl ProbeGeometry {
+    /// The original tool's geometry: 557->555 dot, 15->555 line.
+    pub const DEFAULT: Self = Self {
+        dot_span: DOT_HPIXELSPAN,
+        dot_src_width: DOT_SRC_WIDTH,
+        dot_dst_width: DOT_DST_WIDTH,
+        line_src_width: LINE_SRC_WIDTH,
+        line_dst_width: LINE_DST_WIDTH,
+    };
+
+    /// Widest filter support (in source pixels at 1x) that
+    /// [`at_scale`](Self::at_scale) leaves room for between dots.
+    pub const MAX_SUPPORT: f64 = 4.0;
+
+    /// Smallest ratio [`at_scale`](Self::at_scale) accepts. Its dot span is
+    /// [`MAX_DOT_SPAN`](Self::MAX_DOT_SPAN).
+    pub const MIN_SCALE: f64 = 1.0 / 16.0;
+
+    /// Largest ratio [`at_scale`](Self::at_scale) accepts.
+    pub const MAX_SCALE: f64 = 16.0;
+
+    /// Widest `dot_span` [`validate`](Self::validate) accepts. The dot
+    /// pattern is `dot_span` strips tall, so its size grows with the square of
+    /// the span; this keeps it to a few MB.
+    pub const MAX_DOT_SPAN: usize = 129;
+
+    /// Widest pattern or target [`validate`](Self::validate) accepts.
+    pub const MAX_WIDTH: usize = 16384;
+
+    /// Probe both patterns at horizontal ratio `scale` (`dst / src`).
+    ///
+    /// The dot span is widened for small ratios so that a kernel of up to
+    /// [`MAX_SUPPORT`](Self::MAX_SUPPORT), stretched by `1 / scale`, still fits
+    /// between neighboring dots; the pattern keeps the default's 22 spans per
+    /// row. The line pattern stays 15 wide.
+    ///
+    /// Returns [`Error::InvalidGeometry`] if `scale` is not a finite number in
+    /// [`MIN_SCALE`](Self::MIN_SCALE)`..=`[`MAX_SCALE`](Self::MAX_SCALE).
+    pub fn at_scale(scale: f64) -> Result<Self, Error> {
+        if !(Self::MIN_SCALE..=Self::MAX_SCALE).contains(&scale) {
+            return Err(Error::InvalidGeometry(
+                "scale must be between MIN_SCALE and MAX_SCALE",
+            ));
+        }
+        let reach = (2.0 * Self::MAX_SUPPORT / scale.min(1.0)).ceil() as usize + 1;
+        let dot_span = reach.max(DOT_HPIXELSPAN) | 1;
+        let dot_src_width = 22 * dot_span + 7;
+        let scaled = |src: usize| ((src as f64 * scale).round() as usize).max(1);
+        let geometry = Self {
+            dot_span,
+            dot_src_width,
+            dot_dst_width: scaled(dot_src_width),
+            line_src_width: LINE_SRC_WIDTH,
+            line_dst_width: scaled(LINE_SRC_WIDTH),
+        };
+        geometry.validate()?;
+        Ok(geometry)
+    }
+
+    /// Check that the geometry describes a usable pair of patterns: an odd
+    /// (so nonzero) `dot_span` no wider than
+    /// [`MAX_DOT_SPAN`](Self::MAX_DOT_SPAN), and nonzero widths no wider than
+    /// [`MAX_WIDTH`](Self::MAX_WIDTH).
+    ///
+    /// Returns [`Error::InvalidGeometry`] naming the first field at fault.
+    pub fn validate(&self) -> Result<(), Error> {
+        if self.dot_span.is_multiple_of(2) {
+            return Err(Error::InvalidGeometry("dot_span must be odd"));
+        }
+        if self.dot_span > Self::MAX_DOT_SPAN {
+            return Err(Error::InvalidGeometry("dot_span exceeds MAX_DOT_SPAN"));
+        }
+        let widths = [
+            (
+                self.dot_src_width,
+                "dot_src_width must be nonzero",
+                "dot_src_width exceeds MAX_WIDTH",
+            ),
+            (
+                self.dot_dst_width,
+                "dot_dst_width must be nonzero",
+                "dot_dst_width exceeds MAX_WIDTH",
+            ),
+            (
+                self.line_src_width,
+                "line_src_width must be nonzero",
+                "line_src_width exceeds MAX_WIDTH",
+            ),
+            (
+                self.line_dst_width,
+                "line_dst_width must be nonzero",
+                "line_dst_width exceeds MAX_WIDTH",
+            ),
+        ];
+        for (width, zero, wide) in widths {
+            if width == 0 {
+                return Err(Error::InvalidGeometry(zero));
+            }
+            if width > Self::MAX_WIDTH {
+                return Err(Error::InvalidGeometry(wide));
+            }
+        }
+        Ok(())
+    }
+
+    /// Offset of the dot within its span (the C source's `HCENTER`).
+    pub fn dot_hcenter(&self) -> usize {
+        self.dot_span.saturating_sub(1) / 2
+    }
+
+    /// Number of strips in the dot pattern (one per dot phase).
+    pub fn dot_strips(&self) -> usize {
+        self.dot_span
+    }
+
+    /// Height of the dot pattern, before and after the resize.
+    pub fn dot_height(&self) -> usize {
+        self.dot_strips() * DOT_STRIP_HEIGHT
+    }
+
+    /// Target dimensions of the dot probe.
+    pub fn dot_target(&self) -> (usize, usize) {
+        (self.dot_dst_width, self.dot_height())
+    }
+
+    /// Target dimensions of the line probe.
+    pub fn line_target(&self) -> (usize, usize) {
+        (self.line_dst_width, LINE_DST_HEIGHT)
+    }
+
+    /// Horizontal ratio of the dot probe.
+    pub fn dot_scale(&self) -> f64 {
+        self.dot_dst_width as f64 / self.dot_src_width as f64
+    }
+
+    /// Horizontal ratio of the line probe.
+    pub fn line_scale(&self) -> f64 {
+        self.line_dst_width as f64 / self.line_src_width as f64
+    }
+}
+
+impl Default for ProbeGeometry {
+    fn default() -> Self {
+        Self::DEFAULT
+    }
+}
+
 /// Generate the dot test pattern for downscale analysis.
 /// 557x275 grayscale image with bright dots at phase-offset positions per strip.
 pub fn generate_dot_pattern() -> ImgVec<u8> {
-    let mut pixels = vec![DARK; DOT_SRC_WIDTH * DOT_SRC_HEIGHT];
+    generate_dot_pattern_for(&ProbeGeometry::DEFAULT)
+}
+
+/// [`generate_dot_pattern`] for any [`ProbeGeometry`]:
+/// `dot_src_width` x [`dot_height`](ProbeGeometry::dot_height).
+///
+/// # Panics
+///
+/// If [`ProbeGeometry::validate`] rejects `geometry`.
+pub fn generate_dot_pattern_for(geometry: &ProbeGeometry) -> ImgVec<u8> {
+    if let Err(e) = geometry.validate() {
+        panic!("{e}");
+    }
+    let width = geometry.dot_src_width;
+    let height = geometry.dot_height();
+    let span = geometry.dot_span;
+    let hcenter = geometry.dot_hcenter();
+    let mut pixels = vec![DARK; width * height];
 
-    for j in 0..DOT_SRC_HEIGHT {
+    for j in 0..height {
         let strip = j / DOT_STRIP_HEIGHT;
         let strip_row = j % DOT_STRIP_HEIGHT;
 
@@ -34,31 +228,45 @@ pub fn generate_dot_pattern() -> ImgVec<u8> {
             continue;
         }
 
-        for i in DOT_HCENTER..(DOT_SRC_WIDTH - DOT_HCENTER) {
+        for i in hcenter..width.saturating_sub(hcenter) {
             // Each strip shifts the dot positions by 1 pixel.
             // When i < strip, the C code produces a negative modulus which never
             // equals DOT_HCENTER, so no dot is placed. We replicate that by only
             // checking when i >= strip.
-            if i >= strip && (i - strip) % DOT_HPIXELSPAN == DOT_HCENTER {
-                pixels[j * DOT_SRC_WIDTH + i] = BRIGHT;
+            if i >= strip && (i - strip) % span == hcenter {
+                pixels[j * width + i] = BRIGHT;
             }
         }
     }
 
-    ImgVec::new(pixels, DOT_SRC_WIDTH, DOT_SRC_HEIGHT)
+    ImgVec::new(pixels, width, height)
 }
 
 /// Generate the line test pattern for upscale analysis.
 /// 15x15 grayscale image with a single bright column at the center (x=7).
 pub fn generate_line_pattern() -> ImgVec<u8> {
-    let middle = LINE_SRC_WIDTH / 2; // 7
-    let mut pixels = vec![DARK; LINE_SRC_WIDTH * LINE_SRC_HEIGHT];
+    generate_line_pattern_for(&ProbeGeometry::DEFAULT)
+}
+
+/// [`generate_line_pattern`] for any [`ProbeGeometry`]: `line_src_width` x
+/// [`LINE_SRC_HEIGHT`] with the bright column at `line_src_width / 2`.
+///
+/// # Panics
+///
+/// If [`ProbeGeometry::validate`] rejects `geometry`.
+pub fn generate_line_pattern_for(geometry: &ProbeGeometry) -> ImgVec<u8> {
+    if let Err(e) = geometry.validate() {
+        panic!("{e}");
+    }
+    let width = geometry.line_src_width;
+    let middle = width / 2; // 7
+    let mut pixels = vec![DARK; width * LINE_SRC_HEIGHT];
 
     for y in 0..LINE_SRC_HEIGHT {
-        pixels[y * LINE_SRC_WIDTH + middle] = BRIGHT;
+        pixels[y * width + middle] = BRIGHT;
     }
 
-    ImgVec::new(pixels, LINE_SRC_WIDTH, LINE_SRC_HEIGHT)
+    ImgVec::new(pixels, width, LINE_SRC_HEIGHT)
 }
 
 /// Generate the edge test pattern for edge handling detection.
@@ -73,6 +281,107 @@ pub fn generate_edge_pattern() -> ImgVec<u8> {
     ImgVec::new(pixels, LINE_SRC_WIDTH, LINE_SRC_HEIGHT)
 }
 
+/// The constant test patterns, generated once per process and shared by
+/// every analysis. `T` is the sample format (see [`ProbePixel`]).
+#[derive(Debug)]
+pub struct PatternSet<T = u8> {
+    /// See [`generate_dot_pattern`].
+    pub dot: ImgVec<T>,
+    /// See [`generate_line_pattern`].
+    pub line: ImgVec<T>,
+    /// See [`generate_edge_pattern`].
+    pub edge: ImgVec<T>,
+}
+
+impl<T: ProbePixel> PatternSet<T> {
+    /// Generate all three patterns in format `T`, with [`DARK`] and [`BRIGHT`]
+    /// mapped to `T::DARK` and `T::BRIGHT`.
+    pub fn generate() -> Self {
+        Self {
+            dot: convert(&generate_dot_pattern()),
+            line: convert(&generate_line_pattern()),
+            edge: convert(&generate_edge_pattern()),
+        }
+    }
+}
+
+fn convert<T: ProbePixel>(img: &ImgVec<u8>) -> ImgVec<T> {
+    let pixels = img
+        .buf()
+        .iter()
+        .map(|&v| if v == BRIGHT { T::BRIGHT } else { T::DARK })
+        .collect();
+    ImgVec::new(pixels, img.width(), img.height())
+}
+
+/// The process-wide `u8` pattern set, built on first use.
+///
+/// Other formats are available through [`ProbePixel::patterns`].
+pub fn patterns() -> &'static PatternSet {
+    static PATTERNS: OnceLock<PatternSet> = OnceLock::new();
+    PATTERNS.get_or_init(PatternSet::generate)
+}
+
+/// The dot and line patterns of one [`ProbeGeometry`].
+#[derive(Debug)]
+pub struct GeometryPatterns {
+    /// See [`generate_dot_pattern_for`].
+    pub dot: ImgVec<u8>,
+    /// See [`generate_line_pattern_for`].
+    pub line: ImgVec<u8>,
+}
+
+/// Most geometries [`patterns_for`] keeps cached at once. The patterns of an
+/// [`at_scale`](ProbeGeometry::at_scale) geometry take at most about 4 MB.
+pub const MAX_CACHED_PATTERNS: usize = 16;
+
+/// The shared patterns for `geometry`, generated on first use and cached, up
+/// to [`MAX_CACHED_PATTERNS`] geometries; past that, an arbitrary entry is
+/// dropped from the cache (callers holding it keep their `Arc`).
+///
+/// As with [`dot_offset_table_for`](crate::analyze::dot_offset_table_for),
+/// the cache lock is not held while the patterns are generated.
+///
+/// Returns [`Error::InvalidGeometry`] if [`ProbeGeometry::validate`] rejects
+/// `geometry`.
+pub fn patterns_for(geometry: &ProbeGeometry) -> Result<Arc<GeometryPatterns>, Error> {
+    static CACHE: OnceLock<Mutex<HashMap<ProbeGeometry, Arc<GeometryPatterns>>>> = OnceLock::new();
+    geometry.validate()?;
+    let cache = CACHE.get_or_init(Default::default);
+    let lock = || cache.lock().unwrap_or_else(|e| e.into_inner());
+    if let Some(patterns) = lock().get(geometry) {
+        return Ok(Arc::clone(patterns));
+    }
+
+    let built = Arc::new(GeometryPatterns {
+        dot: generate_dot_pattern_for(geometry),
+        line: generate_line_pattern_for(geometry),
+    });
+    let mut cache = lock();
+    if cache.len() >= MAX_CACHED_PATTERNS
+        && !cache.contains_key(geometry)
+        && let Some(&evict) = cache.keys().next()
+    {
+        cache.remove(&evict);
+    }
+    Ok(Arc::clone(cache.entry(*geometry).or_insert(built)))
+}
+
+/// Borrow the cached dot pattern.
+pub fn dot_pattern() -> ImgRef<'static, u8> {
+    patterns().dot.as_ref()
+}
+
+/// Borrow the cached line pattern.
+pub fn line_pattern() -> ImgRef<'static, u8> {
+    patterns().line.as_ref()
+}
+
+/// Borrow the cached edge pattern.
+pub fn edge_pattern() -> ImgRef<'static, u8> {
+    patterns().edge.as_ref()
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -110,6 +419,83 @@ mod tests {
         assert_eq!(row[DOT_HCENTER + DOT_HPIXELSPAN], BRIGHT);
     }
 
+    #[test]
+    fn geometry_patterns() {
+        let default = patterns_for(&ProbeGeometry::DEFAULT).unwrap();
+        assert_eq!(default.dot.buf(), generate_dot_pattern().buf());
+        assert_eq!(default.line.buf(), generate_line_pattern().buf());
+        assert!(Arc::ptr_eq(
+            &default,
+            &patterns_for(&ProbeGeometry::default()).unwrap()
+        ));
+
+        let quarter = ProbeGeometry::at_scale(0.25).unwrap();
+        assert_eq!(quarter.dot_span % 2, 1);
+        assert!(quarter.dot_span as f64 >= 2.0 * ProbeGeometry::MAX_SUPPORT / 0.25);
+        let dot = generate_dot_pattern_for(&quarter);
+        assert_eq!(
+            (dot.width(), dot.height()),
+            (quarter.dot_src_width, quarter.dot_height())
+        );
+        // Every strip has one dot per span, shifted by one pixel per strip.
+        let hc = quarter.dot_hcenter();
+        for strip in 0..quarter.dot_strips() {
+            let y = strip * DOT_STRIP_HEIGHT + DOT_VCENTER;
+            assert_eq!(
+                dot.buf()[y * dot.width() + hc + strip],
+                BRIGHT,
+                "strip {strip}"
+            );
+        }
+
+        let up = ProbeGeometry::at_scale(3.7).unwrap();
+        assert_eq!(up.dot_span, DOT_HPIXELSPAN);
+        assert_eq!(up.line_dst_width, 56);
+    }
+
+    #[test]
+    fn invalid_geometry_is_rejected() {
+        for bad in [
+            ProbeGeometry {
+                dot_span: 0,
+                ..ProbeGeometry::DEFAULT
+            },
+            ProbeGeometry {
+                dot_span: 24,
+                ..ProbeGeometry::DEFAULT
+            },
+            ProbeGeometry {
+                line_dst_width: 0,
+                ..ProbeGeometry::DEFAULT
+            },
+            ProbeGeometry {
+                dot_span: ProbeGeometry::MAX_DOT_SPAN + 2,
+                ..ProbeGeometry::DEFAULT
+            },
+            ProbeGeometry {
+                dot_dst_width: ProbeGeometry::MAX_WIDTH + 1,
+                ..ProbeGeometry::DEFAULT
+            },
+        ] {
+            assert!(matches!(bad.validate(), Err(Error::InvalidGeometry(_))));
+            assert!(matches!(patterns_for(&bad), Err(Error::InvalidGeometry(_))));
+        }
+        assert!(ProbeGeometry::at_scale(0.1).unwrap().validate().is_ok());
+
+        let smallest = ProbeGeometry::at_scale(ProbeGeometry::MIN_SCALE).unwrap();
+        assert_eq!(smallest.dot_span, ProbeGeometry::MAX_DOT_SPAN);
+        assert!(ProbeGeometry::at_scale(ProbeGeometry::MAX_SCALE).is_ok());
+        for scale in [0.0, -1.0, 0.01, 17.0, f64::NAN, f64::INFINITY] {
+            assert!(
+                matches!(
+                    ProbeGeometry::at_scale(scale),
+                    Err(Error::InvalidGeometry(_))
+                ),
+                "{scale}"
+            );
+        }
+    }
+
     #[test]
     fn line_pattern_dimensions() {
         let img = generate_line_pattern();
@@ -141,4 +527,13 @@ mod tests {
             assert_eq!(img.buf()[y * LINE_SRC_WIDTH + 2], DARK);
         }
     }
+
+    #[test]
+    fn cached_patterns_match_generated() {
+        assert_eq!(dot_pattern().buf(), generate_dot_pattern().buf());
+        assert_eq!(line_pattern().buf(), generate_line_pattern().buf());
+        assert_eq!(edge_pattern().buf(), generate_edge_pattern().buf());
+        // Every call borrows the same buffer.
+        assert_eq!(dot_pattern().buf().as_ptr(), dot_pattern().buf().as_ptr());
+    }
 }
@@ -0,0 +1,146 @@
+//! Sample formats the probe pipeline can run in.
+//!
+//! The probes are defined on `u8` (DARK = 50, BRIGHT = 250), but a resizer with a
+//! wider native format can be probed directly in `u16` or `f32`. The patterns use
+//! the same relative levels in every format, and the analysis decodes samples to
+//! the same normalized weights, so the reconstructed curves are directly
+//! comparable — just without 8-bit quantization.
+
+use std::sync::OnceLock;
+
+use crate::analyze::{srgb_to_linear, weight_lut};
+use crate::pattern::{self, PatternSet};
+
+/// A grayscale sample type the probes can be generated and analyzed in.
+pub trait ProbePixel: Copy + PartialEq + Send + Sync + 'static {
+    /// Background level of the probe patterns.
+    const DARK: Self;
+    /// Foreground (dot/line) level of the probe patterns.
+    const BRIGHT: Self;
+
+    /// A decoder from samples to normalized filter weights
+    /// `(level - DARK) / (BRIGHT - DARK)`, where `level` is linearized first
+    /// when `srgb` is true.
+    fn weight_decoder(srgb: bool) -> impl Fn(Self) -> f64 + Copy;
+
+    /// The process-wide probe patterns in this format, built on first use.
+    fn patterns() -> &'static PatternSet<Self>;
+}
+
+impl ProbePixel for u8 {
+    const DARK: Self = pattern::DARK;
+    const BRIGHT: Self = pattern::BRIGHT;
+
+    fn weight_decoder(srgb: bool) -> impl Fn(Self) -> f64 + Copy {
+        let lut = weight_lut(srgb);
+        move |v| lut[v as usize]
+    }
+
+    fn patterns() -> &'static PatternSet<Self> {
+        pattern::patterns()
+    }
+}
+
+/// 16-bit samples. The levels are the 8-bit ones scaled by 257, so 50 -> 12850
+/// and 250 -> 64250.
+impl ProbePixel for u16 {
+    const DARK: Self = pattern::DARK as u16 * 257;
+    const BRIGHT: Self = pattern::BRIGHT as u16 * 257;
+
+    fn weight_decoder(srgb: bool) -> impl Fn(Self) -> f64 + Copy {
+        let norm = Normalizer::new(
+            srgb,
+            u16::MAX as f64,
+            Self::DARK as f64,
+            Self::BRIGHT as f64,
+        );
+        move |v| norm.weight(v as f64)
+    }
+
+    fn patterns() -> &'static PatternSet<Self> {
+        static PATTERNS: OnceLock<PatternSet<u16>> = OnceLock::new();
+        PATTERNS.get_or_init(PatternSet::generate)
+    }
+}
+
+/// Floating-point samples with nominal range 0.0..=1.0, so DARK = 50/255 and
+/// BRIGHT = 250/255. Values outside the range (ringing) are decoded as-is.
+impl ProbePixel for f32 {
+    const DARK: Self = pattern::DARK as f32 / 255.0;
+    const BRIGHT: Self = pattern::BRIGHT as f32 / 255.0;
+
+    fn weight_decoder(srgb: bool) -> impl Fn(Self) -> f64 + Copy {
+        let norm = Normalizer::new(srgb, 1.0, Self::DARK as f64, Self::BRIGHT as f64);
+        move |v| norm.weight(v as f64)
+    }
+
+    fn patterns() -> &'static PatternSet<Self> {
+        static PATTERNS: OnceLock<PatternSet<f32>> = OnceLock::new();
+        PATTERNS.get_or_init(PatternSet::generate)
+    }
+}
+
+/// Maps native sample values to normalized weights, with the DARK/BRIGHT
+/// anchors linearized once up front.
+#[derive(Clone, Copy)]
+struct Normalizer {
+    srgb: bool,
+    max: f64,
+    dark: f64,
+    inv_range: f64,
+}
+
+impl Normalizer {
+    fn new(srgb: bool, max: f64, dark: f64, bright: f64) -> Self {
+        let (dark, bright) = if srgb {
+            (srgb_to_linear(dark / max), srgb_to_linear(bright / max))
+        } else {
+            (dark, bright)
+        };
+        Self {
+            srgb,
+            max,
+            dark,
+            inv_range: 1.0 / (bright - dark),
+        }
+    }
+
+    fn weight(self, v: f64) -> f64 {
+        let level = if self.srgb {
+            srgb_to_linear(v / self.max)
+        } else {
+            v
+        };
+        (level - self.dark) * self.inv_range
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn check_anchors<T: ProbePixel>() {
+        for srgb in [false, true] {
+            let decode = T::weight_decoder(srgb);
+            assert!(decode(T::DARK).abs() < 1e-6, "srgb={srgb}");
+            assert!((decode(T::BRIGHT) - 1.0).abs() < 1e-6, "srgb={srgb}");
+        }
+    }
+
+    #[test]
+    fn anchors_decode_to_zero_and_one() {
+        check_anchors::<u8>();
+        check_anchors::<u16>();
+        check_anchors::<f32>();
+    }
+
+    #[test]
+    fn wide_patterns_mirror_u8() {
+        let narrow = u8::patterns();
+        let wide = u16::patterns();
+        for (&n, &w) in narrow.dot.buf().iter().zip(wide.dot.buf().iter()) {
+            assert_eq!(n as u16 * 257, w);
+        }
+        assert_eq!(f32::patterns().line.width(), narrow.line.width());
+    }
+}
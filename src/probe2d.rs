@@ -0,0 +1,423 @@
+//! Full 2D kernel reconstruction from a single resize of a dot grid.
+//!
+//! The dot probe sums each strip vertically, so it only ever sees the
+//! horizontal kernel. The grid probe places isolated dots on a square lattice
+//! in both directions and resizes the whole pattern once (557x557 -> 555x555).
+//! As with the dot probe, the slight downscale moves every dot to a different
+//! sub-pixel phase, so taken together the output pixels around all dots sample
+//! the 2D footprint densely. The samples are binned into a [`Kernel2D`], which
+//! also yields both 1D profiles and measures how separable and how radially
+//! symmetric the footprint is: a separable resizer gives a near rank-1
+//! footprint, an elliptical (EWA) one a footprint that depends only on the
+//! distance from the center.
+
+use std::sync::OnceLock;
+
+use imgref::{ImgRef, ImgVec};
+
+use crate::analyze::FilterCurve;
+use crate::pattern::{BRIGHT, DARK};
+use crate::pixel::ProbePixel;
+use crate::score::{self, FilterScore};
+use crate::{AnalysisConfig, Error, ResizeFn};
+
+/// Distance between neighboring grid dots, in both directions.
+pub const GRID_SPAN: usize = 25;
+/// Offset of the first dot from the top-left corner.
+pub const GRID_CENTER: usize = 12; // (GRID_SPAN - 1) / 2
+/// Width and height of the grid pattern (22 dots per row and column).
+pub const GRID_SRC_SIZE: usize = 22 * GRID_SPAN + 7; // 557
+/// Width and height the grid pattern is resized to.
+pub const GRID_DST_SIZE: usize = GRID_SRC_SIZE - 2; // 555
+
+/// Bin width of [`Kernel2D`], in output pixels.
+pub const BIN_STEP: f64 = 0.25;
+
+/// Power-iteration rounds used by [`Kernel2D::separability`].
+const POWER_ROUNDS: usize = 64;
+
+/// Generate the grid pattern: [`GRID_SRC_SIZE`] square, with a single BRIGHT
+/// pixel every [`GRID_SPAN`] pixels in both directions.
+pub fn generate_grid_pattern() -> ImgVec<u8> {
+    let mut pixels = vec![DARK; GRID_SRC_SIZE * GRID_SRC_SIZE];
+    for y in dot_positions() {
+        for x in dot_positions() {
+            pixels[y * GRID_SRC_SIZE + x] = BRIGHT;
+        }
+    }
+    ImgVec::new(pixels, GRID_SRC_SIZE, GRID_SRC_SIZE)
+}
+
+/// Borrow the cached grid pattern.
+pub fn grid_pattern() -> ImgRef<'static, u8> {
+    static PATTERN: OnceLock<ImgVec<u8>> = OnceLock::new();
+    PATTERN.get_or_init(generate_grid_pattern).as_ref()
+}
+
+/// Target dimensions of the grid probe.
+pub fn grid_target() -> (usize, usize) {
+    (GRID_DST_SIZE, GRID_DST_SIZE)
+}
+
+/// Source coordinate of every dot along one axis.
+fn dot_positions() -> impl Iterator<Item = usize> {
+    (GRID_CENTER..GRID_SRC_SIZE - GRID_CENTER).step_by(GRID_SPAN)
+}
+
+/// For each output coordinate along one axis, the signed distance (in output
+/// pixels) to the nearest dot, or `None` if it is too far from every dot.
+fn axis_offsets(dst_size: usize) -> Vec<Option<f64>> {
+    let scale_factor = dst_size as f64 / GRID_SRC_SIZE as f64;
+    let reach = scale_factor * GRID_CENTER as f64;
+    (0..dst_size)
+        .map(|dstpos| {
+            let offset = dot_positions()
+                .map(|k| {
+                    let zp = scale_factor * (k as f64 + 0.5 - GRID_SRC_SIZE as f64 / 2.0)
+                        + dst_size as f64 / 2.0
+                        - 0.5;
+                    dstpos as f64 - zp
+                })
+                .fold(
+                    f64::INFINITY,
+                    |best, o| {
+                        if o.abs() < best.abs() { o } else { best }
+                    },
+                );
+            (offset.abs() <= reach).then_some(offset)
+        })
+        .collect()
+}
+
+/// A reconstructed 2D kernel footprint, binned on a square grid of
+/// [`BIN_STEP`]-wide cells centered on the origin.
+///
+/// Coordinates and values use the same conventions as the downscale curve of
+/// [`analyze_dot`](crate::analyze::analyze_dot): offsets in output pixels, and
+/// weights divided by the pixel area ratio, so a normalized kernel integrates
+/// to about 1.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Kernel2D {
+    /// Bins on each side of the center bin.
+    half: usize,
+    /// Row-major mean weight of each bin (`y` outer); 0 for empty bins.
+    values: Vec<f64>,
+    /// Output size over input size.
+    pub scale_factor: f64,
+}
+
+impl Kernel2D {
+    /// Bins per side.
+    pub fn size(&self) -> usize {
+        2 * self.half + 1
+    }
+
+    /// Distance from the center to the outermost bin centers.
+    pub fn radius(&self) -> f64 {
+        self.half as f64 * BIN_STEP
+    }
+
+    /// Row-major bin values, [`size`](Self::size) squared.
+    pub fn values(&self) -> &[f64] {
+        &self.values
+    }
+
+    /// Value of the bin containing `(x, y)`, or 0 outside the footprint.
+    pub fn value(&self, x: f64, y: f64) -> f64 {
+        match (self.bin(x), self.bin(y)) {
+            (Some(ix), Some(iy)) => self.values[iy * self.size() + ix],
+            _ => 0.0,
+        }
+    }
+
+    fn bin(&self, offset: f64) -> Option<usize> {
+        let i = (offset / BIN_STEP).round() + self.half as f64;
+        (i >= 0.0 && i < self.size() as f64).then_some(i as usize)
+    }
+
+    fn coordinate(&self, i: usize) -> f64 {
+        (i as f64 - self.half as f64) * BIN_STEP
+    }
+
+    /// The horizontal kernel: the footprint integrated over `y`.
+    pub fn horizontal(&self) -> FilterCurve {
+        let n = self.size();
+        self.profile(|i, j| self.values[j * n + i])
+    }
+
+    /// The vertical kernel: the footprint integrated over `x`.
+    pub fn vertical(&self) -> FilterCurve {
+        let n = self.size();
+        self.profile(|i, j| self.values[i * n + j])
+    }
+
+    fn profile(&self, at: impl Fn(usize, usize) -> f64) -> FilterCurve {
+        let n = self.size();
+        let points: Vec<(f64, f64)> = (0..n)
+            .map(|i| {
+                let sum: f64 = (0..n).map(|j| at(i, j)).sum();
+                (self.coordinate(i), sum * BIN_STEP)
+            })
+            .collect();
+        let area = points.iter().map(|&(_, w)| w).sum::<f64>() * BIN_STEP;
+        FilterCurve {
+            points,
+            area,
+            scale_factor: self.scale_factor,
+            is_scatter: false,
+        }
+    }
+
+    /// How close the footprint is to its best rank-1 (separable)
+    /// approximation `K₁`: `1 - ‖K - K₁‖ / ‖K‖` (Frobenius norms), computed
+    /// from the leading singular value as `1 - sqrt(1 - σ₁² / ‖K‖²)`. 1 for a
+    /// separable kernel, lower for elliptical and other non-separable ones.
+    pub fn separability(&self) -> f64 {
+        let n = self.size();
+        let total: f64 = self.values.iter().map(|v| v * v).sum();
+        if total == 0.0 {
+            return 0.0;
+        }
+        // Power iteration on KᵀK for the leading right singular vector.
+        let mut v = vec![1.0 / (n as f64).sqrt(); n];
+        let mut u = vec![0.0; n];
+        let mut sigma_sq = 0.0;
+        for _ in 0..POWER_ROUNDS {
+            for (row, u) in self.values.chunks_exact(n).zip(u.iter_mut()) {
+                *u = row.iter().zip(&v).map(|(k, v)| k * v).sum();
+            }
+            sigma_sq = u.iter().map(|u| u * u).sum();
+            for (j, v) in v.iter_mut().enumerate() {
+                *v = (0..n).map(|i| self.values[i * n + j] * u[i]).sum();
+            }
+            let norm = v.iter().map(|v| v * v).sum::<f64>().sqrt();
+            if norm == 0.0 {
+                return 0.0;
+            }
+            v.iter_mut().for_each(|v| *v /= norm);
+        }
+        1.0 - (1.0 - sigma_sq / total).max(0.0).sqrt()
+    }
+
+    /// How well the footprint is explained by a function of the radius alone:
+    /// `1 - ‖K - R‖ / ‖K‖`, where `R` averages `K` over rings one bin wide.
+    /// 1 for a radially symmetric (EWA) kernel. Only bins inside the inscribed
+    /// circle are compared, so the square corners do not count.
+    ///
+    /// Small kernels are sampled on a coarse pixel grid, so even a truly
+    /// radial one scores noticeably below 1; compare resizers against each
+    /// other rather than against a fixed threshold.
+    pub fn radial_symmetry(&self) -> f64 {
+        let n = self.size();
+        let rings = self.half + 1;
+        let ring_of = |ix: usize, iy: usize| {
+            let r = self.coordinate(ix).hypot(self.coordinate(iy)) / BIN_STEP;
+            let ring = r.round() as usize;
+            (ring < rings).then_some(ring)
+        };
+
+        let mut sums = vec![(0.0, 0usize); rings];
+        for iy in 0..n {
+            for ix in 0..n {
+                if let Some(ring) = ring_of(ix, iy) {
+                    sums[ring].0 += self.values[iy * n + ix];
+                    sums[ring].1 += 1;
+                }
+            }
+        }
+
+        let (mut residual, mut total) = (0.0, 0.0);
+        for iy in 0..n {
+            for ix in 0..n {
+                if let Some(ring) = ring_of(ix, iy) {
+                    let k = self.values[iy * n + ix];
+                    let mean = sums[ring].0 / sums[ring].1 as f64;
+                    residual += (k - mean) * (k - mean);
+                    total += k * k;
+                }
+            }
+        }
+        if total == 0.0 {
+            0.0
+        } else {
+            1.0 - (residual / total).sqrt()
+        }
+    }
+}
+
+/// Reconstruct the 2D footprint from a resized grid pattern.
+///
+/// # Panics
+///
+/// If the image is not [`grid_target`] in size.
+pub fn analyze_grid<T: ProbePixel>(img: &ImgRef<'_, T>, srgb: bool) -> Kernel2D {
+    let (tw, th) = grid_target();
+    assert_eq!(
+        (img.width(), img.height()),
+        (tw, th),
+        "grid image must be {tw}x{th}"
+    );
+
+    let scale_factor = tw as f64 / GRID_SRC_SIZE as f64;
+    let pixel_area = scale_factor * scale_factor;
+    let half = (scale_factor * GRID_CENTER as f64 / BIN_STEP).floor() as usize;
+    let n = 2 * half + 1;
+    let mut kernel = Kernel2D {
+        half,
+        values: vec![0.0; n * n],
+        scale_factor,
+    };
+
+    let decode = T::weight_decoder(srgb);
+    let x_offsets = axis_offsets(tw);
+    let y_offsets = axis_offsets(th);
+    let mut counts = vec![0u32; n * n];
+    for (row, dy) in img.rows().zip(&y_offsets) {
+        let Some(iy) = dy.and_then(|dy| kernel.bin(dy)) else {
+            continue;
+        };
+        for (&v, dx) in row[..tw].iter().zip(&x_offsets) {
+            if let Some(ix) = dx.and_then(|dx| kernel.bin(dx)) {
+                kernel.values[iy * n + ix] += decode(v) / pixel_area;
+                counts[iy * n + ix] += 1;
+            }
+        }
+    }
+    for (value, &count) in kernel.values.iter_mut().zip(&counts) {
+        if count > 0 {
+            *value /= count as f64;
+        }
+    }
+    kernel
+}
+
+/// Everything [`analyze_2d`] learns from one grid resize.
+#[derive(Debug, Clone)]
+pub struct Analysis2D {
+    /// The reconstructed footprint.
+    pub kernel: Kernel2D,
+    /// See [`Kernel2D::separability`].
+    pub separability: f64,
+    /// See [`Kernel2D::radial_symmetry`].
+    pub radial_symmetry: f64,
+    /// [`Kernel2D::horizontal`] scored against the known filters, best first.
+    pub horizontal_scores: Vec<FilterScore>,
+    /// [`Kernel2D::vertical`] scored against the known filters, best first.
+    pub vertical_scores: Vec<FilterScore>,
+}
+
+impl Analysis2D {
+    /// True when the footprint is close to rank 1, as for any resizer that runs
+    /// separate horizontal and vertical passes.
+    pub fn is_separable(&self) -> bool {
+        self.separability > 0.99
+    }
+}
+
+/// Probe `resize` with the grid pattern: one call, [`GRID_SRC_SIZE`] square
+/// to [`grid_target`]. Only `config.srgb` is used.
+pub fn analyze_2d(resize: &ResizeFn, config: &AnalysisConfig) -> Result<Analysis2D, Error> {
+    let (w, h) = grid_target();
+    let resized = resize(grid_pattern(), w, h);
+    crate::check_dimensions(&resized, w, h)?;
+    let kernel = analyze_grid(&resized.as_ref(), config.srgb);
+    Ok(Analysis2D {
+        separability: kernel.separability(),
+        radial_symmetry: kernel.radial_symmetry(),
+        horizontal_scores: score::score_against_all(&kernel.horizontal()),
+        vertical_scores: score::score_against_all(&kernel.vertical()),
+        kernel,
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::test_util::lanczos3;
+    use crate::{KnownFilter, perfect_resize};
+
+    /// Elliptical-average resize with a radial tent of radius 1.5 (in output
+    /// pixels), the simplest non-separable kernel.
+    fn radial_tent(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        const RADIUS: f64 = 1.5;
+        let (sx, sy) = (
+            src.width() as f64 / w as f64,
+            src.height() as f64 / h as f64,
+        );
+        let mut out = Vec::with_capacity(w * h);
+        for y in 0..h {
+            let cy = (y as f64 + 0.5) * sy - 0.5;
+            for x in 0..w {
+                let cx = (x as f64 + 0.5) * sx - 0.5;
+                let (mut acc, mut total) = (0.0, 0.0);
+                let reach = (RADIUS * sx).ceil() as isize;
+                for j in cy as isize - reach..=cy as isize + reach + 1 {
+                    for i in cx as isize - reach..=cx as isize + reach + 1 {
+                        let r = ((i as f64 - cx) / sx).hypot((j as f64 - cy) / sy);
+                        let k = (1.0 - r / RADIUS).max(0.0);
+                        if k > 0.0 {
+                            let xi = i.clamp(0, src.width() as isize - 1) as usize;
+                            let yj = j.clamp(0, src.height() as isize - 1) as usize;
+                            acc += src.buf()[yj * src.stride() + xi] as f64 * k;
+                            total += k;
+                        }
+                    }
+                }
+                out.push((acc / total).round().clamp(0.0, 255.0) as u8);
+            }
+        }
+        ImgVec::new(out, w, h)
+    }
+
+    #[test]
+    fn grid_pattern_layout() {
+        let img = grid_pattern();
+        assert_eq!((img.width(), img.height()), (GRID_SRC_SIZE, GRID_SRC_SIZE));
+        assert_eq!(dot_positions().count(), 22);
+        let bright = img.buf().iter().filter(|&&v| v == BRIGHT).count();
+        assert_eq!(bright, 22 * 22);
+        assert_eq!(img.buf()[GRID_CENTER * GRID_SRC_SIZE + GRID_CENTER], BRIGHT);
+    }
+
+    #[test]
+    fn separable_resizer_recovers_both_axes() {
+        let result = analyze_2d(&lanczos3, &AnalysisConfig::default()).unwrap();
+        assert!(
+            result.is_separable(),
+            "separability {}",
+            result.separability
+        );
+        for scores in [&result.horizontal_scores, &result.vertical_scores] {
+            assert_eq!(scores[0].filter, KnownFilter::Lanczos3, "{}", scores[0]);
+            assert!(scores[0].correlation > 0.99, "{}", scores[0]);
+        }
+        let peak = result.kernel.value(0.0, 0.0);
+        let expected = KnownFilter::Lanczos3.evaluate(0.0).powi(2);
+        assert!((peak - expected).abs() < 0.1, "peak {peak}");
+        let h = result.kernel.horizontal();
+        assert!((h.area - 1.0).abs() < 0.05, "area {}", h.area);
+    }
+
+    #[test]
+    fn elliptical_resizer_is_radial_not_separable() {
+        let config = AnalysisConfig::default();
+        let ewa = analyze_2d(&radial_tent, &config).unwrap();
+        assert!(!ewa.is_separable(), "separability {}", ewa.separability);
+        for separable in [
+            analyze_2d(&lanczos3, &config).unwrap(),
+            analyze_2d(
+                &|src: ImgRef<'_, u8>, w, h| perfect_resize(src, w, h, KnownFilter::Box),
+                &config,
+            )
+            .unwrap(),
+        ] {
+            assert!(separable.separability > ewa.separability);
+            assert!(
+                ewa.radial_symmetry > separable.radial_symmetry,
+                "{} vs {}",
+                ewa.radial_symmetry,
+                separable.radial_symmetry
+            );
+        }
+    }
+}
@@ -1,6 +1,9 @@
+use std::collections::VecDeque;
+
 use imgref::{ImgRef, ImgVec};
 
-use crate::filters::KnownFilter;
+use crate::filters::{Kernel, KnownFilter};
+use crate::parallel;
 
 /// A single weight entry: which source pixel contributes and by how much.
 #[derive(Debug, Clone)]
@@ -15,77 +18,182 @@ pub struct PixelWeights {
     pub entries: Vec<WeightEntry>,
 }
 
-/// Compute the exact pixel weight table for a 1D resize operation.
+/// A contiguous, CSR-style weight table for a 1D resize operation.
 ///
-/// For each output pixel, returns the list of source pixels and their
-/// normalized weights. Uses clamp edge handling (repeats the edge pixel
-/// for out-of-bounds accesses).
-pub fn compute_weights(filter: KnownFilter, src_size: usize, dst_size: usize) -> Vec<PixelWeights> {
-    let scale = dst_size as f64 / src_size as f64;
-    let filter_scale = if scale < 1.0 { 1.0 / scale } else { 1.0 };
-    let support = filter.support() * filter_scale;
-
-    let mut result = Vec::with_capacity(dst_size);
-
-    for dst_x in 0..dst_size {
-        // Center of this output pixel in source coordinates.
-        let center = (dst_x as f64 + 0.5) / scale - 0.5;
-
-        let left = (center - support).ceil() as isize;
-        let right = (center + support).floor() as isize;
-
-        let mut entries = Vec::new();
-        let mut total = 0.0;
-
-        for src_x in left..=right {
-            // Clamp to valid range.
-            let clamped = src_x.clamp(0, src_size as isize - 1) as usize;
-            let distance = (src_x as f64 - center) / filter_scale;
-            let w = filter.evaluate(distance);
-
-            if w.abs() > 1e-12 {
-                // Merge with existing entry for same clamped pixel.
-                if let Some(existing) = entries
-                    .iter_mut()
-                    .find(|e: &&mut WeightEntry| e.src_pixel == clamped)
-                {
-                    existing.weight += w;
-                } else {
-                    entries.push(WeightEntry {
-                        src_pixel: clamped,
-                        weight: w,
-                    });
+/// The entries of every output pixel are stored back to back in two packed
+/// arrays (`src_pixels` and `weights`); `offsets[i]..offsets[i + 1]` is the
+/// run belonging to output pixel `i`. Building it costs three allocations in
+/// total, and iterating it walks memory linearly.
+#[derive(Debug, Clone, PartialEq)]
+pub struct WeightTable {
+    offsets: Vec<usize>,
+    src_pixels: Vec<usize>,
+    weights: Vec<f64>,
+}
+
+impl WeightTable {
+    /// Compute the exact weight table for resizing `src_size` pixels to
+    /// `dst_size` pixels with `filter`. See [`compute_weights`].
+    pub fn new(filter: KnownFilter, src_size: usize, dst_size: usize) -> Self {
+        Self::with_kernel(&filter, src_size, dst_size)
+    }
+
+    /// [`WeightTable::new`] evaluating the taps through any [`Kernel`], such as
+    /// a [`FilterTable`](crate::filters::FilterTable) built once and reused for
+    /// many tables.
+    pub fn with_kernel<K: Kernel + ?Sized>(kernel: &K, src_size: usize, dst_size: usize) -> Self {
+        let scale = dst_size as f64 / src_size as f64;
+        let filter_scale = if scale < 1.0 { 1.0 / scale } else { 1.0 };
+        let support = kernel.support() * filter_scale;
+
+        let mut offsets = Vec::with_capacity(dst_size + 1);
+        let mut src_pixels = Vec::new();
+        let mut weights = Vec::new();
+        offsets.push(0);
+
+        for dst_x in 0..dst_size {
+            // Center of this output pixel in source coordinates.
+            let center = (dst_x as f64 + 0.5) / scale - 0.5;
+
+            let left = (center - support).ceil() as isize;
+            let right = (center + support).floor() as isize;
+
+            let start = src_pixels.len();
+            let mut total = 0.0;
+
+            for src_x in left..=right {
+                // Clamp to valid range.
+                let clamped = src_x.clamp(0, src_size as isize - 1) as usize;
+                let distance = (src_x as f64 - center) / filter_scale;
+                let w = kernel.evaluate(distance);
+
+                if w.abs() > 1e-12 {
+                    // Clamped indices never decrease, so a repeated pixel can
+                    // only be the most recent entry: merge into it.
+                    if src_pixels.len() > start && src_pixels.last() == Some(&clamped) {
+                        *weights.last_mut().unwrap() += w;
+                    } else {
+                        src_pixels.push(clamped);
+                        weights.push(w);
+                    }
+                    total += w;
                 }
-                total += w;
             }
-        }
 
-        // Normalize so weights sum to 1.
-        if total.abs() > 1e-12 {
-            for e in &mut entries {
-                e.weight /= total;
+            // Normalize so weights sum to 1.
+            if total.abs() > 1e-12 {
+                for w in &mut weights[start..] {
+                    *w /= total;
+                }
             }
+
+            offsets.push(src_pixels.len());
         }
 
-        result.push(PixelWeights { entries });
+        Self {
+            offsets,
+            src_pixels,
+            weights,
+        }
+    }
+
+    /// Number of output pixels.
+    pub fn len(&self) -> usize {
+        self.offsets.len() - 1
     }
 
-    result
+    /// True if the table has no output pixels.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Source pixel indices and weights contributing to output pixel `dst`.
+    pub fn pixel(&self, dst: usize) -> (&[usize], &[f64]) {
+        let range = self.offsets[dst]..self.offsets[dst + 1];
+        (&self.src_pixels[range.clone()], &self.weights[range])
+    }
+
+    /// Iterate the `(src_pixels, weights)` runs of every output pixel in order.
+    pub fn iter(&self) -> impl ExactSizeIterator<Item = (&[usize], &[f64])> + '_ {
+        (0..self.len()).map(|dst| self.pixel(dst))
+    }
+
+    /// Start of each output pixel's run, plus a final end marker (`len() + 1` entries).
+    pub fn offsets(&self) -> &[usize] {
+        &self.offsets
+    }
+
+    /// Packed source pixel indices of all output pixels.
+    pub fn src_pixels(&self) -> &[usize] {
+        &self.src_pixels
+    }
+
+    /// Packed weights of all output pixels, parallel to [`src_pixels`](Self::src_pixels).
+    pub fn weights(&self) -> &[f64] {
+        &self.weights
+    }
+
+    /// Expand into the per-pixel [`PixelWeights`] form.
+    pub fn to_pixel_weights(&self) -> Vec<PixelWeights> {
+        self.iter()
+            .map(|(src_pixels, weights)| PixelWeights {
+                entries: src_pixels
+                    .iter()
+                    .zip(weights)
+                    .map(|(&src_pixel, &weight)| WeightEntry { src_pixel, weight })
+                    .collect(),
+            })
+            .collect()
+    }
+}
+
+impl From<&[PixelWeights]> for WeightTable {
+    fn from(pixels: &[PixelWeights]) -> Self {
+        let mut offsets = Vec::with_capacity(pixels.len() + 1);
+        let mut src_pixels = Vec::new();
+        let mut weights = Vec::new();
+        offsets.push(0);
+        for pw in pixels {
+            for e in &pw.entries {
+                src_pixels.push(e.src_pixel);
+                weights.push(e.weight);
+            }
+            offsets.push(src_pixels.len());
+        }
+        Self {
+            offsets,
+            src_pixels,
+            weights,
+        }
+    }
+}
+
+/// Compute the exact pixel weight table for a 1D resize operation, in the
+/// contiguous [`WeightTable`] layout.
+pub fn compute_weight_table(filter: KnownFilter, src_size: usize, dst_size: usize) -> WeightTable {
+    WeightTable::new(filter, src_size, dst_size)
+}
+
+/// Compute the exact pixel weight table for a 1D resize operation.
+///
+/// For each output pixel, returns the list of source pixels and their
+/// normalized weights. Uses clamp edge handling (repeats the edge pixel
+/// for out-of-bounds accesses). [`compute_weight_table`] returns the same
+/// weights without one allocation per output pixel.
+pub fn compute_weights(filter: KnownFilter, src_size: usize, dst_size: usize) -> Vec<PixelWeights> {
+    compute_weight_table(filter, src_size, dst_size).to_pixel_weights()
 }
 
 /// Apply 1D weights to a row of source pixels, producing one output row.
-fn apply_weights_row(weights: &[PixelWeights], src_row: &[u8]) -> Vec<u8> {
-    weights
-        .iter()
-        .map(|pw| {
-            let val: f64 = pw
-                .entries
-                .iter()
-                .map(|e| src_row[e.src_pixel] as f64 * e.weight)
-                .sum();
-            val.round().clamp(0.0, 255.0) as u8
-        })
-        .collect()
+fn apply_weights_row(weights: &WeightTable, src_row: &[u8], dst_row: &mut [u8]) {
+    for (out, (src_pixels, pixel_weights)) in dst_row.iter_mut().zip(weights.iter()) {
+        let val: f64 = src_pixels
+            .iter()
+            .zip(pixel_weights)
+            .map(|(&s, &w)| src_row[s] as f64 * w)
+            .sum();
+        *out = val.round().clamp(0.0, 255.0) as u8;
+    }
 }
 
 /// Generate the mathematically perfect resize output for a given filter.
@@ -98,41 +206,301 @@ pub fn perfect_resize(
     dst_height: usize,
     filter: KnownFilter,
 ) -> ImgVec<u8> {
-    let h_weights = compute_weights(filter, src.width(), dst_width);
+    resize_exact(src, dst_width, dst_height, &filter, 1)
+}
+
+/// [`perfect_resize`] with the weights taken from any [`Kernel`].
+///
+/// With a [`FilterTable`](crate::filters::FilterTable) this skips the
+/// transcendental math of large resizes; the result then differs from
+/// [`perfect_resize`] only where the table's error moves a pixel across a
+/// rounding boundary.
+pub fn perfect_resize_with_kernel<K: Kernel + ?Sized>(
+    src: ImgRef<'_, u8>,
+    dst_width: usize,
+    dst_height: usize,
+    kernel: &K,
+) -> ImgVec<u8> {
+    resize_exact(src, dst_width, dst_height, kernel, 1)
+}
+
+/// Multithreaded [`perfect_resize`] for large images, using up to
+/// `max_threads` threads (`None` uses the available parallelism).
+///
+/// The horizontal pass is split into bands of source rows and the vertical
+/// pass into bands of output rows; every band reads the same two weight
+/// tables. Each output pixel is computed with exactly the same arithmetic as
+/// [`perfect_resize`], so the output is bit-identical to it.
+pub fn perfect_resize_parallel(
+    src: ImgRef<'_, u8>,
+    dst_width: usize,
+    dst_height: usize,
+    filter: KnownFilter,
+    max_threads: Option<usize>,
+) -> ImgVec<u8> {
+    let threads = parallel::worker_count(max_threads, src.height().max(dst_height));
+    resize_exact(src, dst_width, dst_height, &filter, threads)
+}
+
+fn resize_exact<K: Kernel + ?Sized>(
+    src: ImgRef<'_, u8>,
+    dst_width: usize,
+    dst_height: usize,
+    kernel: &K,
+    threads: usize,
+) -> ImgVec<u8> {
+    let h_weights = WeightTable::with_kernel(kernel, src.width(), dst_width);
 
     // Horizontal pass: resize each row.
     let mut temp = vec![0u8; dst_width * src.height()];
-    for y in 0..src.height() {
+    parallel::for_each_chunk_mut(&mut temp, dst_width, threads, |y, dst_row| {
         let src_row = &src.buf()[y * src.stride()..][..src.width()];
-        let dst_row = apply_weights_row(&h_weights, src_row);
-        temp[y * dst_width..][..dst_width].copy_from_slice(&dst_row);
-    }
+        apply_weights_row(&h_weights, src_row, dst_row);
+    });
 
     // Vertical pass (only if height changes).
     if dst_height == src.height() {
         return ImgVec::new(temp, dst_width, dst_height);
     }
 
-    let v_weights = compute_weights(filter, src.height(), dst_height);
+    let v_weights = WeightTable::with_kernel(kernel, src.height(), dst_height);
     let mut result = vec![0u8; dst_width * dst_height];
 
-    for x in 0..dst_width {
-        // Extract the column from temp.
-        let col: Vec<u8> = (0..src.height()).map(|y| temp[y * dst_width + x]).collect();
+    // Walk output rows in order; every pixel sums its taps in table order.
+    parallel::for_each_chunk_mut(&mut result, dst_width, threads, |y, dst_row| {
+        let (src_rows, row_weights) = v_weights.pixel(y);
+        for (x, out) in dst_row.iter_mut().enumerate() {
+            let val: f64 = src_rows
+                .iter()
+                .zip(row_weights)
+                .map(|(&s, &w)| temp[s * dst_width + x] as f64 * w)
+                .sum();
+            *out = val.round().clamp(0.0, 255.0) as u8;
+        }
+    });
+
+    ImgVec::new(result, dst_width, dst_height)
+}
 
-        for (y, pw) in v_weights.iter().enumerate() {
-            let val: f64 = pw
-                .entries
+/// The output of [`perfect_resize`], produced one row at a time.
+///
+/// Only the horizontally resized source rows under the current vertical taps
+/// are kept (a few rows of `dst_width` pixels), so the reference image is never
+/// materialized. Rows come out top to bottom and are bit-identical to the
+/// corresponding rows of [`perfect_resize`] /
+/// [`perfect_resize_with_kernel`].
+#[derive(Debug, Clone)]
+pub struct ReferenceRows<'a> {
+    src: ImgRef<'a, u8>,
+    h_weights: WeightTable,
+    /// `None` when the height is unchanged and rows pass through.
+    v_weights: Option<WeightTable>,
+    dst_height: usize,
+    next: usize,
+    /// Horizontally resized source rows, by increasing source row index.
+    cache: VecDeque<(usize, Vec<u8>)>,
+    spare: Vec<Vec<u8>>,
+}
+
+impl<'a> ReferenceRows<'a> {
+    /// Stream the [`perfect_resize`] of `src` to `dst_width` x `dst_height`.
+    pub fn new(
+        src: ImgRef<'a, u8>,
+        dst_width: usize,
+        dst_height: usize,
+        filter: KnownFilter,
+    ) -> Self {
+        Self::with_kernel(src, dst_width, dst_height, &filter)
+    }
+
+    /// Stream the [`perfect_resize_with_kernel`] of `src`.
+    pub fn with_kernel<K: Kernel + ?Sized>(
+        src: ImgRef<'a, u8>,
+        dst_width: usize,
+        dst_height: usize,
+        kernel: &K,
+    ) -> Self {
+        let v_weights = (dst_height != src.height())
+            .then(|| WeightTable::with_kernel(kernel, src.height(), dst_height));
+        Self {
+            src,
+            h_weights: WeightTable::with_kernel(kernel, src.width(), dst_width),
+            v_weights,
+            dst_height,
+            next: 0,
+            cache: VecDeque::new(),
+            spare: Vec::new(),
+        }
+    }
+
+    /// Width of every output row.
+    pub fn width(&self) -> usize {
+        self.h_weights.len()
+    }
+
+    /// Rows not yet produced.
+    pub fn rows_left(&self) -> usize {
+        self.dst_height - self.next
+    }
+
+    /// Write the next output row into `dst_row` and return its index, or
+    /// `None` once all rows have been produced.
+    ///
+    /// # Panics
+    ///
+    /// If `dst_row` is not [`width`](Self::width) long.
+    pub fn next_into(&mut self, dst_row: &mut [u8]) -> Option<usize> {
+        assert_eq!(
+            dst_row.len(),
+            self.width(),
+            "row must be {} wide",
+            self.width()
+        );
+        if self.next == self.dst_height {
+            return None;
+        }
+        let y = self.next;
+        self.next += 1;
+
+        let Some(v_weights) = self.v_weights.take() else {
+            apply_weights_row(&self.h_weights, self.src_row(y), dst_row);
+            return Some(y);
+        };
+        let (src_rows, row_weights) = v_weights.pixel(y);
+        self.retain_from(src_rows.first().copied().unwrap_or(0));
+        for &s in src_rows {
+            self.ensure_cached(s);
+        }
+        let rows: Vec<&[u8]> = src_rows.iter().map(|&s| self.cached(s)).collect();
+        // Same taps in the same order as the vertical pass of `resize_exact`.
+        for (x, out) in dst_row.iter_mut().enumerate() {
+            let val: f64 = rows
                 .iter()
-                .map(|e| col[e.src_pixel] as f64 * e.weight)
+                .zip(row_weights)
+                .map(|(row, &w)| row[x] as f64 * w)
                 .sum();
-            result[y * dst_width + x] = val.round().clamp(0.0, 255.0) as u8;
+            *out = val.round().clamp(0.0, 255.0) as u8;
+        }
+        self.v_weights = Some(v_weights);
+        Some(y)
+    }
+
+    fn src_row(&self, y: usize) -> &'a [u8] {
+        let src = self.src;
+        &src.buf()[y * src.stride()..][..src.width()]
+    }
+
+    /// Recycle cached rows below `first`, which later output rows never read:
+    /// the first tap of each output row never moves up.
+    fn retain_from(&mut self, first: usize) {
+        while self.cache.front().is_some_and(|&(s, _)| s < first) {
+            let (_, buf) = self.cache.pop_front().expect("front exists");
+            self.spare.push(buf);
+        }
+    }
+
+    fn ensure_cached(&mut self, s: usize) {
+        let pos = self.cache.partition_point(|&(c, _)| c < s);
+        if self.cache.get(pos).is_some_and(|&(c, _)| c == s) {
+            return;
+        }
+        let mut buf = self.spare.pop().unwrap_or_default();
+        buf.resize(self.width(), 0);
+        apply_weights_row(&self.h_weights, self.src_row(s), &mut buf);
+        self.cache.insert(pos, (s, buf));
+    }
+
+    fn cached(&self, s: usize) -> &[u8] {
+        let pos = self.cache.partition_point(|&(c, _)| c < s);
+        &self.cache[pos].1
+    }
+}
+
+/// Faster, vectorization-friendly variant of [`perfect_resize`].
+///
+/// Uses the same weight tables and the same separable structure (including the
+/// rounded 8-bit intermediate), but accumulates in `f32` and runs the vertical
+/// pass over whole output rows at once: every tap scales one intermediate row
+/// into a row accumulator, a loop shape the compiler turns into SIMD code.
+///
+/// Rounding of values that land within `f32` precision of a half step can
+/// differ, so individual pixels may be off by one from [`perfect_resize`],
+/// which remains the bit-exact reference.
+pub fn perfect_resize_fast(
+    src: ImgRef<'_, u8>,
+    dst_width: usize,
+    dst_height: usize,
+    filter: KnownFilter,
+) -> ImgVec<u8> {
+    let h_weights = compute_weight_table(filter, src.width(), dst_width);
+    let h_taps: Vec<f32> = h_weights.weights().iter().map(|&w| w as f32).collect();
+
+    // Horizontal pass: widen a band of FAST_LANES source rows into one
+    // interleaved block, so each tap scales the same column of every row in
+    // the band with a single vector multiply-add.
+    let mut temp = vec![0u8; dst_width * src.height()];
+    let mut block = vec![[0.0_f32; FAST_LANES]; src.width()];
+    for band in (0..src.height()).step_by(FAST_LANES) {
+        let rows = FAST_LANES.min(src.height() - band);
+        for r in 0..rows {
+            let src_row = &src.buf()[(band + r) * src.stride()..][..src.width()];
+            for (px, &v) in block.iter_mut().zip(src_row) {
+                px[r] = v as f32;
+            }
+        }
+        for x in 0..dst_width {
+            let range = h_weights.offsets()[x]..h_weights.offsets()[x + 1];
+            let mut acc = [0.0_f32; FAST_LANES];
+            for (&s, &w) in h_weights.src_pixels()[range.clone()]
+                .iter()
+                .zip(&h_taps[range])
+            {
+                for (a, &p) in acc.iter_mut().zip(&block[s]) {
+                    *a += p * w;
+                }
+            }
+            for (r, &a) in acc[..rows].iter().enumerate() {
+                temp[(band + r) * dst_width + x] = round_to_u8(a);
+            }
+        }
+    }
+
+    // Vertical pass (only if height changes).
+    if dst_height == src.height() {
+        return ImgVec::new(temp, dst_width, dst_height);
+    }
+
+    let v_weights = compute_weight_table(filter, src.height(), dst_height);
+    let mut result = vec![0u8; dst_width * dst_height];
+    let mut acc = vec![0.0_f32; dst_width];
+
+    for (y, dst_row) in result.chunks_exact_mut(dst_width.max(1)).enumerate() {
+        acc.fill(0.0);
+        let (src_rows, row_weights) = v_weights.pixel(y);
+        for (&s, &w) in src_rows.iter().zip(row_weights) {
+            let w = w as f32;
+            let temp_row = &temp[s * dst_width..][..dst_width];
+            for (a, &p) in acc.iter_mut().zip(temp_row) {
+                *a += p as f32 * w;
+            }
+        }
+        for (out, &a) in dst_row.iter_mut().zip(&acc) {
+            *out = round_to_u8(a);
         }
     }
 
     ImgVec::new(result, dst_width, dst_height)
 }
 
+/// Rows processed together by the horizontal pass of [`perfect_resize_fast`].
+const FAST_LANES: usize = 8;
+
+/// Round half away from zero and saturate. Adding 0.5 and truncating avoids a
+/// `roundf` library call per pixel on targets without a rounding instruction.
+fn round_to_u8(v: f32) -> u8 {
+    (v.clamp(0.0, 255.0) + 0.5) as u8
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -188,4 +556,81 @@ mod tests {
         let mid = dst.buf()[(15 / 2) * 555 + 555 / 2];
         assert!(mid > 200, "peak should be bright, got {mid}");
     }
+
+    #[test]
+    fn weight_table_matches_pixel_weights() {
+        for filter in crate::filters::KnownFilter::all_named() {
+            for (src, dst) in [(15, 555), (557, 555), (100, 7)] {
+                let table = compute_weight_table(*filter, src, dst);
+                assert_eq!(table.len(), dst);
+                let roundtrip = WeightTable::from(table.to_pixel_weights().as_slice());
+                assert_eq!(roundtrip, table);
+                for (src_pixels, _) in table.iter() {
+                    // Entries are strictly increasing: clamped duplicates were merged.
+                    assert!(src_pixels.windows(2).all(|p| p[0] < p[1]));
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn fast_resize_within_one_of_exact() {
+        let src = pattern::generate_dot_pattern();
+        for filter in crate::filters::KnownFilter::all_named() {
+            for (w, h) in [(555, 275), (200, 90)] {
+                let exact = perfect_resize(src.as_ref(), w, h, *filter);
+                let fast = perfect_resize_fast(src.as_ref(), w, h, *filter);
+                assert_eq!((fast.width(), fast.height()), (w, h));
+                let max_diff = exact
+                    .buf()
+                    .iter()
+                    .zip(fast.buf().iter())
+                    .map(|(&a, &b)| a.abs_diff(b))
+                    .max()
+                    .unwrap();
+                assert!(
+                    max_diff <= 1,
+                    "{}: {w}x{h} differs by {max_diff}",
+                    filter.name()
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn reference_rows_match_perfect_resize() {
+        let src = crate::pattern::dot_pattern();
+        for (w, h, filter) in [
+            (555, 275, KnownFilter::Lanczos3),
+            (200, 90, KnownFilter::Mitchell),
+            (600, 410, KnownFilter::Box),
+        ] {
+            let full = perfect_resize(src, w, h, filter);
+            let mut rows = ReferenceRows::new(src, w, h, filter);
+            let mut row = vec![0u8; w];
+            for y in 0..h {
+                assert_eq!(rows.next_into(&mut row), Some(y));
+                assert_eq!(row, &full.buf()[y * w..][..w], "{filter} {w}x{h} row {y}");
+            }
+            assert_eq!(rows.next_into(&mut row), None);
+            // Only the rows under one output row's taps are ever held.
+            let max_taps = WeightTable::new(filter, src.height(), h)
+                .iter()
+                .map(|(taps, _)| taps.len())
+                .max()
+                .unwrap();
+            assert!(rows.cache.len() <= max_taps);
+        }
+    }
+
+    #[test]
+    fn parallel_resize_is_bit_identical() {
+        let src = pattern::generate_dot_pattern();
+        for (w, h) in [(555, 275), (200, 90), (600, 300), (555, 1)] {
+            let serial = perfect_resize(src.as_ref(), w, h, KnownFilter::Lanczos3);
+            let parallel =
+                perfect_resize_parallel(src.as_ref(), w, h, KnownFilter::Lanczos3, Some(3));
+            assert_eq!(serial.buf(), parallel.buf(), "{w}x{h}");
+        }
+    }
 }
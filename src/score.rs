@@ -1,5 +1,8 @@
-use crate::analyze::FilterCurve;
-use crate::filters::KnownFilter;
+use imgref::ImgRef;
+
+use crate::analyze::{CompactCurve, FilterCurve};
+use crate::filters::{FilterTable, Kernel, KnownFilter};
+use crate::reference::ReferenceRows;
 
 /// Scoring result for one reference filter compared against a reconstructed curve.
 #[derive(Debug, Clone)]
@@ -27,8 +30,12 @@ impl std::fmt::Display for FilterScore {
     }
 }
 
+/// Width, in source pixels, of the bins scatter curves are averaged into
+/// before scoring.
+pub const SCORE_BIN_WIDTH: f64 = 0.02;
+
 /// Bin scatter data into uniform intervals and average.
-fn bin_scatter(points: &[(f64, f64)], bin_width: f64) -> Vec<(f64, f64)> {
+pub(crate) fn bin_scatter(points: &[(f64, f64)], bin_width: f64) -> Vec<(f64, f64)> {
     if points.is_empty() {
         return Vec::new();
     }
@@ -59,6 +66,9 @@ fn bin_scatter(points: &[(f64, f64)], bin_width: f64) -> Vec<(f64, f64)> {
 }
 
 /// Compute Pearson correlation coefficient between two equal-length vectors.
+///
+/// Two-pass reference for the fused accumulation in [`PreparedCurve`].
+#[cfg(test)]
 fn pearson(a: &[f64], b: &[f64]) -> f64 {
     let n = a.len();
     if n < 2 {
@@ -96,90 +106,215 @@ fn detect_support(points: &[(f64, f64)], threshold: f64) -> f64 {
         .fold(0.0_f64, f64::max)
 }
 
-/// Score a reconstructed curve against a single reference filter.
-pub fn score_against(curve: &FilterCurve, filter: KnownFilter) -> FilterScore {
-    // For scatter data, bin first; for connected data, use directly.
-    let comparison_points = if curve.is_scatter {
-        bin_scatter(&curve.points, 0.02)
-    } else {
-        curve.points.clone()
-    };
+/// A reconstructed curve reduced to the data every filter score needs.
+///
+/// Scatter curves are binned, and the mean and variance of the measured weights
+/// are taken, once up front. Scoring any number of filters is then a single pass
+/// over the points with one set of running sums per filter.
+#[derive(Debug, Clone)]
+pub struct PreparedCurve {
+    offsets: Vec<f64>,
+    actual: Vec<f64>,
+    /// `actual` minus its mean.
+    centered: Vec<f64>,
+    var_actual: f64,
+    detected_support: f64,
+}
 
-    if comparison_points.is_empty() {
-        return FilterScore {
-            filter,
-            correlation: 0.0,
-            rms_error: f64::INFINITY,
-            max_error: f64::INFINITY,
-            detected_support: 0.0,
-            expected_support: filter.support(),
+/// Running sums for one filter during [`PreparedCurve::score_many`].
+#[derive(Clone, Copy, Default)]
+struct ScoreSums {
+    /// Running mean of the reference and the sum of squared deviations from
+    /// it (Welford's method). Unlike `Σr² - (Σr)²/n`, this stays accurate
+    /// for a reference that is nearly constant over the curve's range.
+    mean_ref: f64,
+    m2_ref: f64,
+    /// Co-moment of the centered actual weights and the reference, updated
+    /// against both running means so no large products cancel.
+    cross: f64,
+    sq_err: f64,
+    max_err: f64,
+}
+
+impl PreparedCurve {
+    /// Bin (for scatter data) and summarize `curve` for scoring.
+    pub fn new(curve: &FilterCurve) -> Self {
+        let binned;
+        let points: &[(f64, f64)] = if curve.is_scatter {
+            binned = bin_scatter(&curve.points, SCORE_BIN_WIDTH);
+            &binned
+        } else {
+            &curve.points
         };
+        Self::from_points(points)
     }
 
-    // Evaluate reference filter at the same offsets.
-    let actual: Vec<f64> = comparison_points.iter().map(|p| p.1).collect();
-    let reference: Vec<f64> = comparison_points
-        .iter()
-        .map(|p| filter.evaluate(p.0))
-        .collect();
+    /// Summarize `curve` for scoring. A [`CompactCurve`] binned at
+    /// [`SCORE_BIN_WIDTH`] (see [`FilterCurve::compact`]) is used as is;
+    /// a finer-binned scatter curve is binned again.
+    pub fn from_compact(curve: &CompactCurve) -> Self {
+        let points: Vec<(f64, f64)> = curve.points().collect();
+        if curve.is_scatter && curve.bin_width() < SCORE_BIN_WIDTH {
+            Self::from_points(&bin_scatter(&points, SCORE_BIN_WIDTH))
+        } else {
+            Self::from_points(&points)
+        }
+    }
 
-    let correlation = pearson(&actual, &reference);
+    fn from_points(points: &[(f64, f64)]) -> Self {
+        let offsets: Vec<f64> = points.iter().map(|p| p.0).collect();
+        let actual: Vec<f64> = points.iter().map(|p| p.1).collect();
+        let mean = if actual.is_empty() {
+            0.0
+        } else {
+            actual.iter().sum::<f64>() / actual.len() as f64
+        };
+        let centered: Vec<f64> = actual.iter().map(|a| a - mean).collect();
+        let var_actual = centered.iter().map(|d| d * d).sum();
+
+        Self {
+            offsets,
+            actual,
+            centered,
+            var_actual,
+            detected_support: detect_support(points, 0.005),
+        }
+    }
 
-    // RMS error
-    let n = actual.len() as f64;
-    let rms_error = (actual
-        .iter()
-        .zip(reference.iter())
-        .map(|(a, r)| (a - r).powi(2))
-        .sum::<f64>()
-        / n)
-        .sqrt();
-
-    // Max error
-    let max_error = actual
-        .iter()
-        .zip(reference.iter())
-        .map(|(a, r)| (a - r).abs())
-        .fold(0.0_f64, f64::max);
+    /// Number of comparison points (bins, for scatter curves).
+    pub fn len(&self) -> usize {
+        self.offsets.len()
+    }
+
+    /// True if there is nothing to score against.
+    pub fn is_empty(&self) -> bool {
+        self.offsets.is_empty()
+    }
+
+    /// Score against a single reference filter.
+    pub fn score(&self, filter: KnownFilter) -> FilterScore {
+        self.score_many(&[filter])
+            .pop()
+            .expect("one score per filter")
+    }
+
+    /// Score against every kernel in `kernels` in one pass over the points.
+    /// Returns the scores in the same order as `kernels`.
+    ///
+    /// Pass [`KnownFilter`]s for exact scores, or [`FilterTable`]s to skip the
+    /// per-point filter math at the table's documented accuracy.
+    pub fn score_many<K: Kernel>(&self, kernels: &[K]) -> Vec<FilterScore> {
+        if self.is_empty() {
+            return kernels
+                .iter()
+                .map(|kernel| kernel.filter())
+                .map(|filter| FilterScore {
+                    filter,
+                    correlation: 0.0,
+                    rms_error: f64::INFINITY,
+                    max_error: f64::INFINITY,
+                    detected_support: 0.0,
+                    expected_support: filter.support(),
+                })
+                .collect();
+        }
+
+        let mut sums = vec![ScoreSums::default(); kernels.len()];
+        let mut mean_centered = 0.0;
+        for (i, ((&x, &a), &da)) in self
+            .offsets
+            .iter()
+            .zip(&self.actual)
+            .zip(&self.centered)
+            .enumerate()
+        {
+            let count = (i + 1) as f64;
+            // The centered weights' own running mean, for the co-moment. It
+            // ends at (nearly) zero but is not zero along the way.
+            let dx = da - mean_centered;
+            mean_centered += dx / count;
+            for (acc, kernel) in sums.iter_mut().zip(kernels) {
+                let r = kernel.evaluate(x);
+                let err = a - r;
+                let delta = r - acc.mean_ref;
+                acc.mean_ref += delta / count;
+                acc.m2_ref += delta * (r - acc.mean_ref);
+                acc.cross += dx * (r - acc.mean_ref);
+                acc.sq_err += err * err;
+                acc.max_err = acc.max_err.max(err.abs());
+            }
+        }
+
+        let n = self.len() as f64;
+        kernels
+            .iter()
+            .zip(&sums)
+            .map(|(kernel, acc)| {
+                let filter = kernel.filter();
+                let correlation = if self.len() < 2 {
+                    0.0
+                } else {
+                    let denom = (self.var_actual * acc.m2_ref).sqrt();
+                    if denom < 1e-15 {
+                        0.0
+                    } else {
+                        acc.cross / denom
+                    }
+                };
+
+                FilterScore {
+                    filter,
+                    correlation,
+                    rms_error: (acc.sq_err / n).sqrt(),
+                    max_error: acc.max_err,
+                    detected_support: self.detected_support,
+                    expected_support: filter.support(),
+                }
+            })
+            .collect()
+    }
 
-    let detected_support = detect_support(&comparison_points, 0.005);
+    /// Score against all built-in filters, sorted by correlation (best first).
+    pub fn score_all(&self) -> Vec<FilterScore> {
+        let mut scores = self.score_many(KnownFilter::all_named());
+        scores.sort_by(|a, b| {
+            b.correlation
+                .partial_cmp(&a.correlation)
+                .unwrap_or(std::cmp::Ordering::Equal)
+        });
+        scores
+    }
 
-    FilterScore {
-        filter,
-        correlation,
-        rms_error,
-        max_error,
-        detected_support,
-        expected_support: filter.support(),
+    /// [`PreparedCurve::score_all`] using the shared [`FilterTable::named`]
+    /// tables instead of exact filter evaluation.
+    pub fn score_all_tabulated(&self) -> Vec<FilterScore> {
+        let mut scores = self.score_many(FilterTable::named());
+        scores.sort_by(|a, b| {
+            b.correlation
+                .partial_cmp(&a.correlation)
+                .unwrap_or(std::cmp::Ordering::Equal)
+        });
+        scores
     }
 }
 
+/// Score a reconstructed curve against a single reference filter.
+pub fn score_against(curve: &FilterCurve, filter: KnownFilter) -> FilterScore {
+    PreparedCurve::new(curve).score(filter)
+}
+
 /// Score a curve against all built-in filters, returning results sorted by correlation (best first).
+///
+/// The curve is prepared once and all filters are scored in a single pass; see
+/// [`PreparedCurve`].
 pub fn score_against_all(curve: &FilterCurve) -> Vec<FilterScore> {
-    let mut scores: Vec<FilterScore> = KnownFilter::all_named()
-        .iter()
-        .map(|&f| score_against(curve, f))
-        .collect();
-
-    scores.sort_by(|a, b| {
-        b.correlation
-            .partial_cmp(&a.correlation)
-            .unwrap_or(std::cmp::Ordering::Equal)
-    });
-
-    scores
+    PreparedCurve::new(curve).score_all()
 }
 
 /// Compute SSIM between two equal-sized grayscale images.
 /// Uses 8x8 block-based comparison with standard SSIM constants.
 pub fn ssim(a: &[u8], b: &[u8], width: usize, height: usize) -> f64 {
-    const K1: f64 = 0.01;
-    const K2: f64 = 0.03;
-    const L: f64 = 255.0;
-    let c1 = (K1 * L) * (K1 * L);
-    let c2 = (K2 * L) * (K2 * L);
-    const BLOCK: usize = 8;
-
+    let (c1, c2) = ssim_constants();
     assert_eq!(a.len(), width * height);
     assert_eq!(b.len(), width * height);
 
@@ -203,45 +338,129 @@ pub fn ssim(a: &[u8], b: &[u8], width: usize, height: usize) -> f64 {
         return num / den;
     }
 
-    let blocks_x = width / BLOCK;
-    let blocks_y = height / BLOCK;
     let mut total_ssim = 0.0;
     let mut count = 0;
 
-    for by in 0..blocks_y {
-        for bx in 0..blocks_x {
-            let mut sum_a = 0.0_f64;
-            let mut sum_b = 0.0_f64;
-            let mut sum_aa = 0.0_f64;
-            let mut sum_bb = 0.0_f64;
-            let mut sum_ab = 0.0_f64;
-            let n = (BLOCK * BLOCK) as f64;
-
-            for dy in 0..BLOCK {
-                for dx in 0..BLOCK {
-                    let y = by * BLOCK + dy;
-                    let x = bx * BLOCK + dx;
-                    let va = a[y * width + x] as f64;
-                    let vb = b[y * width + x] as f64;
-                    sum_a += va;
-                    sum_b += vb;
-                    sum_aa += va * va;
-                    sum_bb += vb * vb;
-                    sum_ab += va * vb;
-                }
+    for by in 0..height / BLOCK {
+        let a_rows = std::array::from_fn(|dy| &a[(by * BLOCK + dy) * width..][..width]);
+        let b_rows = std::array::from_fn(|dy| &b[(by * BLOCK + dy) * width..][..width]);
+        accumulate_block_row(&a_rows, &b_rows, &mut total_ssim, &mut count);
+    }
+
+    if count == 0 {
+        return 1.0;
+    }
+    total_ssim / count as f64
+}
+
+/// Block size of [`ssim`].
+const BLOCK: usize = 8;
+
+/// The usual SSIM stabilizers `(K1 L)²` and `(K2 L)²` for 8-bit samples.
+fn ssim_constants() -> (f64, f64) {
+    const K1: f64 = 0.01;
+    const K2: f64 = 0.03;
+    const L: f64 = 255.0;
+    ((K1 * L) * (K1 * L), (K2 * L) * (K2 * L))
+}
+
+/// Add the SSIM of each full [`BLOCK`]-square block of one block row to
+/// `total`, left to right. Shared by [`ssim`] and [`ssim_against_reference`]
+/// so both sum in exactly the same order.
+fn accumulate_block_row(
+    a_rows: &[&[u8]; BLOCK],
+    b_rows: &[&[u8]; BLOCK],
+    total: &mut f64,
+    count: &mut usize,
+) {
+    let (c1, c2) = ssim_constants();
+    let width = a_rows[0].len();
+    for bx in 0..width / BLOCK {
+        let mut sum_a = 0.0_f64;
+        let mut sum_b = 0.0_f64;
+        let mut sum_aa = 0.0_f64;
+        let mut sum_bb = 0.0_f64;
+        let mut sum_ab = 0.0_f64;
+        let n = (BLOCK * BLOCK) as f64;
+
+        for dy in 0..BLOCK {
+            for dx in 0..BLOCK {
+                let x = bx * BLOCK + dx;
+                let va = a_rows[dy][x] as f64;
+                let vb = b_rows[dy][x] as f64;
+                sum_a += va;
+                sum_b += vb;
+                sum_aa += va * va;
+                sum_bb += vb * vb;
+                sum_ab += va * vb;
             }
+        }
 
-            let mean_a = sum_a / n;
-            let mean_b = sum_b / n;
-            let var_a = sum_aa / n - mean_a * mean_a;
-            let var_b = sum_bb / n - mean_b * mean_b;
-            let cov = sum_ab / n - mean_a * mean_b;
+        let mean_a = sum_a / n;
+        let mean_b = sum_b / n;
+        let var_a = sum_aa / n - mean_a * mean_a;
+        let var_b = sum_bb / n - mean_b * mean_b;
+        let cov = sum_ab / n - mean_a * mean_b;
 
-            let num = (2.0 * mean_a * mean_b + c1) * (2.0 * cov + c2);
-            let den = (mean_a.powi(2) + mean_b.powi(2) + c1) * (var_a + var_b + c2);
-            total_ssim += num / den;
-            count += 1;
+        let num = (2.0 * mean_a * mean_b + c1) * (2.0 * cov + c2);
+        let den = (mean_a.powi(2) + mean_b.powi(2) + c1) * (var_a + var_b + c2);
+        *total += num / den;
+        *count += 1;
+    }
+}
+
+/// [`ssim`] of `actual` against the [`perfect_resize`] of `src` to the same
+/// size, without materializing the reference image.
+///
+/// Reference rows are produced by [`ReferenceRows`] one 8-row band at
+/// a time and scored immediately, so the extra memory is that band plus the
+/// few horizontally resized source rows under the vertical taps. The result is
+/// bit-identical to `ssim(actual, perfect_resize(src, ..), ..)`.
+///
+/// [`perfect_resize`]: crate::reference::perfect_resize
+pub fn ssim_against_reference(
+    actual: ImgRef<'_, u8>,
+    src: ImgRef<'_, u8>,
+    filter: KnownFilter,
+) -> f64 {
+    ssim_against_kernel(actual, src, &filter)
+}
+
+/// [`ssim_against_reference`] with the reference weights taken from any
+/// [`Kernel`], matching [`perfect_resize_with_kernel`].
+///
+/// [`perfect_resize_with_kernel`]: crate::reference::perfect_resize_with_kernel
+pub fn ssim_against_kernel<K: Kernel + ?Sized>(
+    actual: ImgRef<'_, u8>,
+    src: ImgRef<'_, u8>,
+    kernel: &K,
+) -> f64 {
+    let (width, height) = (actual.width(), actual.height());
+    let mut reference = ReferenceRows::with_kernel(src, width, height, kernel);
+    let actual_row = |y: usize| &actual.buf()[y * actual.stride()..][..width];
+
+    if width < BLOCK || height < BLOCK {
+        // Global SSIM needs the whole image, but it is at most a few rows or
+        // columns here.
+        let mut a = Vec::with_capacity(width * height);
+        let mut b = vec![0u8; width * height];
+        for (y, row) in b.chunks_exact_mut(width.max(1)).enumerate() {
+            a.extend_from_slice(actual_row(y));
+            reference.next_into(row);
+        }
+        return ssim(&a, &b, width, height);
+    }
+
+    let mut band = vec![0u8; BLOCK * width];
+    let mut total_ssim = 0.0;
+    let mut count = 0;
+    for by in 0..height / BLOCK {
+        for row in band.chunks_exact_mut(width) {
+            reference.next_into(row);
         }
+        let a_rows = std::array::from_fn(|dy| actual_row(by * BLOCK + dy));
+        let b_rows = std::array::from_fn(|dy| &band[dy * width..][..width]);
+        accumulate_block_row(&a_rows, &b_rows, &mut total_ssim, &mut count);
     }
 
     if count == 0 {
@@ -250,9 +469,177 @@ pub fn ssim(a: &[u8], b: &[u8], width: usize, height: usize) -> f64 {
     total_ssim / count as f64
 }
 
+/// Window size used by [`ssim_windowed`] callers that have no preference; the
+/// same size as the blocks of [`ssim`].
+pub const SSIM_WINDOW: usize = 8;
+
+/// Output window rows per band in [`ssim_windowed`]. Fixed, so that the
+/// result does not depend on the thread count.
+const SSIM_BAND_ROWS: usize = 32;
+
+/// Sliding-window SSIM between two equal-sized grayscale images.
+///
+/// Averages the SSIM of every `window` x `window` square fully inside the
+/// image (stride 1), rather than the non-overlapping blocks of [`ssim`]. The
+/// window sums come from summed-area tables of `a`, `b`, `a²`, `b²` and `ab`
+/// in exact integer arithmetic, so the cost is O(pixels) whatever the window
+/// size and the per-window statistics are exact until the final division.
+///
+/// The image is split into fixed bands of window rows, each with its own
+/// tables, spread over up to `max_threads` threads (`None` uses the available
+/// parallelism). The result is identical for every thread count. A window
+/// larger than the image is shrunk to `min(width, height)`.
+///
+/// # Panics
+///
+/// If `window` is zero or a buffer is not `width * height` long.
+pub fn ssim_windowed(
+    a: &[u8],
+    b: &[u8],
+    width: usize,
+    height: usize,
+    window: usize,
+    max_threads: Option<usize>,
+) -> f64 {
+    assert!(window > 0, "SSIM window must be at least 1");
+    assert_eq!(a.len(), width * height);
+    assert_eq!(b.len(), width * height);
+    let window = window.min(width).min(height);
+    if window == 0 {
+        return 1.0;
+    }
+
+    let out_w = width - window + 1;
+    let out_h = height - window + 1;
+    let bands = out_h.div_ceil(SSIM_BAND_ROWS);
+    let threads = crate::parallel::worker_count(max_threads, bands);
+    let images = WindowedImages {
+        a,
+        b,
+        width,
+        window,
+    };
+    let band_sums = crate::parallel::map_indexed(bands, threads, |band| {
+        let first = band * SSIM_BAND_ROWS;
+        images.band_ssim_sum(first, SSIM_BAND_ROWS.min(out_h - first))
+    });
+    band_sums.iter().sum::<f64>() / (out_w * out_h) as f64
+}
+
+#[derive(Clone, Copy)]
+struct WindowedImages<'a> {
+    a: &'a [u8],
+    b: &'a [u8],
+    width: usize,
+    window: usize,
+}
+
+/// One row of the five summed-area tables, each `width + 1` long with a
+/// leading zero column.
+struct SatRow {
+    a: Vec<u64>,
+    b: Vec<u64>,
+    aa: Vec<u64>,
+    bb: Vec<u64>,
+    ab: Vec<u64>,
+}
+
+impl SatRow {
+    fn zero(width: usize) -> Self {
+        Self {
+            a: vec![0; width + 1],
+            b: vec![0; width + 1],
+            aa: vec![0; width + 1],
+            bb: vec![0; width + 1],
+            ab: vec![0; width + 1],
+        }
+    }
+
+    /// The next table row: `self` plus the prefix sums of one image row.
+    fn next(&self, ra: &[u8], rb: &[u8]) -> Self {
+        let mut row = Self::zero(ra.len());
+        let mut acc = [0_u64; 5];
+        for (x, (&va, &vb)) in ra.iter().zip(rb).enumerate() {
+            let (va, vb) = (u64::from(va), u64::from(vb));
+            acc[0] += va;
+            acc[1] += vb;
+            acc[2] += va * va;
+            acc[3] += vb * vb;
+            acc[4] += va * vb;
+            row.a[x + 1] = acc[0];
+            row.b[x + 1] = acc[1];
+            row.aa[x + 1] = acc[2];
+            row.bb[x + 1] = acc[3];
+            row.ab[x + 1] = acc[4];
+        }
+        // Element-wise, so this half vectorizes.
+        for (dst, src) in [
+            (&mut row.a, &self.a),
+            (&mut row.b, &self.b),
+            (&mut row.aa, &self.aa),
+            (&mut row.bb, &self.bb),
+            (&mut row.ab, &self.ab),
+        ] {
+            for (d, &s) in dst.iter_mut().zip(src.iter()) {
+                *d += s;
+            }
+        }
+        row
+    }
+}
+
+impl WindowedImages<'_> {
+    /// Sum of the SSIM of the windows with top rows `first..first + rows`.
+    fn band_ssim_sum(&self, first: usize, rows: usize) -> f64 {
+        let (c1, c2) = ssim_constants();
+
+        let (w, win) = (self.width, self.window);
+        let n = (win * win) as i128;
+        let n2 = (n * n) as f64;
+        let out_w = w - win + 1;
+
+        // Table rows first..first + rows + win, relative to the band's top row.
+        let mut table = Vec::with_capacity(rows + win);
+        table.push(SatRow::zero(w));
+        for y in first..first + rows + win - 1 {
+            let row = &table[table.len() - 1];
+            let next = row.next(&self.a[y * w..][..w], &self.b[y * w..][..w]);
+            table.push(next);
+        }
+
+        let mut total = 0.0;
+        for y in 0..rows {
+            let (top, bottom) = (&table[y], &table[y + win]);
+            let window_sum =
+                |t: &[u64], b: &[u64], x: usize| i128::from(b[x + win] + t[x] - b[x] - t[x + win]);
+            for x in 0..out_w {
+                let sa = window_sum(&top.a, &bottom.a, x);
+                let sb = window_sum(&top.b, &bottom.b, x);
+                let saa = window_sum(&top.aa, &bottom.aa, x);
+                let sbb = window_sum(&top.bb, &bottom.bb, x);
+                let sab = window_sum(&top.ab, &bottom.ab, x);
+
+                // Scaled by n² (in i128, so even a full-image window cannot
+                // overflow) so everything stays integral until here.
+                let mean_a = sa as f64 / n as f64;
+                let mean_b = sb as f64 / n as f64;
+                let var_a = (n * saa - sa * sa) as f64 / n2;
+                let var_b = (n * sbb - sb * sb) as f64 / n2;
+                let cov = (n * sab - sa * sb) as f64 / n2;
+
+                let num = (2.0 * mean_a * mean_b + c1) * (2.0 * cov + c2);
+                let den = (mean_a * mean_a + mean_b * mean_b + c1) * (var_a + var_b + c2);
+                total += num / den;
+            }
+        }
+        total
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::test_util::lanczos3;
 
     #[test]
     fn pearson_perfect_correlation() {
@@ -283,6 +670,91 @@ mod tests {
         assert!(s < 0.1, "ssim of opposite images should be low: {s}");
     }
 
+    /// Direct per-window evaluation of what [`ssim_windowed`] computes.
+    fn brute_force_windowed(a: &[u8], b: &[u8], w: usize, h: usize, win: usize) -> f64 {
+        let (c1, c2) = ((0.01_f64 * 255.0).powi(2), (0.03_f64 * 255.0).powi(2));
+        let n = (win * win) as f64;
+        let mut total = 0.0;
+        for y0 in 0..=h - win {
+            for x0 in 0..=w - win {
+                let px = |img: &[u8], dx, dy| img[(y0 + dy) * w + x0 + dx] as f64;
+                let (mut sa, mut sb) = (0.0, 0.0);
+                for dy in 0..win {
+                    for dx in 0..win {
+                        sa += px(a, dx, dy);
+                        sb += px(b, dx, dy);
+                    }
+                }
+                let (ma, mb) = (sa / n, sb / n);
+                let (mut va, mut vb, mut cov) = (0.0, 0.0, 0.0);
+                for dy in 0..win {
+                    for dx in 0..win {
+                        let (da, db) = (px(a, dx, dy) - ma, px(b, dx, dy) - mb);
+                        va += da * da;
+                        vb += db * db;
+                        cov += da * db;
+                    }
+                }
+                let (va, vb, cov) = (va / n, vb / n, cov / n);
+                total += (2.0 * ma * mb + c1) * (2.0 * cov + c2)
+                    / ((ma * ma + mb * mb + c1) * (va + vb + c2));
+            }
+        }
+        total / ((w - win + 1) * (h - win + 1)) as f64
+    }
+
+    fn noise(len: usize, mut state: u32) -> Vec<u8> {
+        (0..len)
+            .map(|_| {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                state as u8
+            })
+            .collect()
+    }
+
+    #[test]
+    fn ssim_against_reference_is_bit_identical() {
+        let src = crate::pattern::dot_pattern();
+        for (w, h) in [(555, 275), (203, 61), (5, 40)] {
+            let actual = crate::perfect_resize(src, w, h, KnownFilter::Mitchell);
+            let reference = crate::perfect_resize(src, w, h, KnownFilter::Lanczos3);
+            let fused = ssim_against_reference(actual.as_ref(), src, KnownFilter::Lanczos3);
+            assert_eq!(fused, ssim(actual.buf(), reference.buf(), w, h), "{w}x{h}");
+        }
+    }
+
+    #[test]
+    fn ssim_windowed_matches_brute_force() {
+        let (w, h) = (53, 71);
+        let a = noise(w * h, 1);
+        let b: Vec<u8> = a
+            .iter()
+            .zip(noise(w * h, 7))
+            .map(|(&v, n)| v.saturating_add(n % 40))
+            .collect();
+        for win in [1, 3, SSIM_WINDOW, 11] {
+            let fast = ssim_windowed(&a, &b, w, h, win, Some(1));
+            let slow = brute_force_windowed(&a, &b, w, h, win);
+            assert!((fast - slow).abs() < 1e-12, "win={win}: {fast} vs {slow}");
+        }
+        let serial = ssim_windowed(&a, &b, w, h, SSIM_WINDOW, Some(1));
+        let threaded = ssim_windowed(&a, &b, w, h, SSIM_WINDOW, Some(4));
+        assert_eq!(serial, threaded);
+    }
+
+    #[test]
+    fn ssim_windowed_extremes() {
+        let img = noise(40 * 30, 3);
+        assert!((ssim_windowed(&img, &img, 40, 30, SSIM_WINDOW, None) - 1.0).abs() < 1e-12);
+        let (dark, bright) = (vec![0u8; 64 * 64], vec![255u8; 64 * 64]);
+        assert!(ssim_windowed(&dark, &bright, 64, 64, SSIM_WINDOW, None) < 0.1);
+        // Window larger than the image shrinks to fit.
+        let tiny = noise(5 * 4, 9);
+        assert!((ssim_windowed(&tiny, &tiny, 5, 4, 16, None) - 1.0).abs() < 1e-12);
+    }
+
     #[test]
     fn score_triangle_against_triangle() {
         // Generate a synthetic triangle filter curve
@@ -329,4 +801,125 @@ mod tests {
         assert_eq!(scores[0].filter, KnownFilter::Lanczos3);
         assert!(scores[0].correlation > 0.999);
     }
+
+    #[test]
+    fn tabulated_scores_track_exact() {
+        let points: Vec<(f64, f64)> = (-300..=300)
+            .map(|i| {
+                let x = i as f64 / 97.0;
+                (x, KnownFilter::Mitchell.evaluate(x))
+            })
+            .collect();
+        let prepared = PreparedCurve::new(&FilterCurve {
+            points,
+            area: 1.0,
+            scale_factor: 37.0,
+            is_scatter: false,
+        });
+
+        let exact = prepared.score_all();
+        let tabulated = prepared.score_all_tabulated();
+        assert_eq!(tabulated[0].filter, KnownFilter::Mitchell);
+        for (e, t) in exact.iter().zip(&tabulated) {
+            assert_eq!(e.filter, t.filter);
+            assert!((e.correlation - t.correlation).abs() < 1e-5);
+            assert!((e.rms_error - t.rms_error).abs() < 1e-5);
+        }
+    }
+
+    #[test]
+    fn correlation_survives_a_nearly_constant_reference() {
+        // A reference with a large constant part and a tiny shape: the
+        // one-pass sum of squares loses all of its variance to cancellation.
+        struct Lifted;
+        impl Kernel for Lifted {
+            fn filter(&self) -> KnownFilter {
+                KnownFilter::Mitchell
+            }
+            fn evaluate(&self, x: f64) -> f64 {
+                1e6 + 1e-4 * KnownFilter::Mitchell.evaluate(x)
+            }
+        }
+        let points: Vec<(f64, f64)> = (-300..=300)
+            .map(|i| {
+                let x = i as f64 / 97.0;
+                (x, KnownFilter::CatmullRom.evaluate(x))
+            })
+            .collect();
+        let prepared = PreparedCurve::new(&FilterCurve {
+            points: points.clone(),
+            area: 1.0,
+            scale_factor: 37.0,
+            is_scatter: false,
+        });
+
+        let actual: Vec<f64> = points.iter().map(|p| p.1).collect();
+        let reference: Vec<f64> = points.iter().map(|p| Lifted.evaluate(p.0)).collect();
+        let expected = pearson(&actual, &reference);
+        let score = &prepared.score_many(&[Lifted])[0];
+        assert!(expected > 0.9, "{expected}");
+        assert!(
+            (score.correlation - expected).abs() < 1e-6,
+            "{} vs {expected}",
+            score.correlation
+        );
+    }
+
+    #[test]
+    fn compact_curve_scores_like_the_raw_curve() {
+        let full = crate::analyze(&lanczos3, &crate::AnalysisConfig::default()).unwrap();
+        let raw = full.downscale_curve.as_ref().unwrap();
+        let from_raw = PreparedCurve::new(raw).score_all();
+        let from_compact = PreparedCurve::from_compact(&raw.compact()).score_all();
+        assert_eq!(from_raw.len(), from_compact.len());
+        for (r, c) in from_raw.iter().zip(&from_compact) {
+            assert_eq!(r.filter, c.filter);
+            assert!((r.correlation - c.correlation).abs() < 1e-5);
+            assert!((r.rms_error - c.rms_error).abs() < 1e-5);
+        }
+
+        let compact = full.clone().into_compact();
+        assert_eq!(compact.scores[0].filter, full.scores[0].filter);
+        assert_eq!(compact.best_match().unwrap().filter, KnownFilter::Lanczos3);
+        assert_eq!(compact.render_graph().width(), full.render_graph().width());
+    }
+
+    #[test]
+    fn fused_scores_match_two_pass() {
+        // Noisy scatter data exercises binning as well.
+        let points: Vec<(f64, f64)> = (0..4000)
+            .map(|i| {
+                let x = -3.0 + i as f64 * 0.0015;
+                let noise = ((i * 7919) % 101) as f64 / 101.0 - 0.5;
+                (x, KnownFilter::CatmullRom.evaluate(x) + 0.01 * noise)
+            })
+            .collect();
+        let curve = FilterCurve {
+            points,
+            area: 0.0,
+            scale_factor: 0.99,
+            is_scatter: true,
+        };
+
+        let binned = bin_scatter(&curve.points, 0.02);
+        let actual: Vec<f64> = binned.iter().map(|p| p.1).collect();
+        for score in score_against_all(&curve) {
+            let reference: Vec<f64> = binned.iter().map(|p| score.filter.evaluate(p.0)).collect();
+            let expected = pearson(&actual, &reference);
+            assert!(
+                (score.correlation - expected).abs() < 1e-12,
+                "{}: {} vs {expected}",
+                score.filter,
+                score.correlation
+            );
+            let rms = (actual
+                .iter()
+                .zip(&reference)
+                .map(|(a, r)| (a - r).powi(2))
+                .sum::<f64>()
+                / actual.len() as f64)
+                .sqrt();
+            assert!((score.rms_error - rms).abs() < 1e-12);
+        }
+    }
 }
@@ -0,0 +1,292 @@
+//! Push-based analysis for resizers that produce their output a row at a time.
+//!
+//! Each stream is created for one probe's target size, fed the output rows in
+//! top-to-bottom order with `push_row`, and finalized with `finish`. None of
+//! them keeps the full frame: [`DotStream`] folds every row into its strip's
+//! running sums as it arrives, and [`LineStream`] / [`EdgeStream`] keep only
+//! the scanlines their analysis reads. The results are identical to running
+//! [`analyze_dot`](crate::analyze::analyze_dot),
+//! [`analyze_line`](crate::analyze::analyze_line) or
+//! [`edge::classify`] on the completed image.
+
+use std::marker::PhantomData;
+
+use crate::Error;
+use crate::analyze::{self, FilterCurve};
+use crate::edge::{self, EdgeMode};
+use crate::pattern::{
+    DOT_DST_HEIGHT, DOT_NUM_STRIPS, DOT_STRIP_HEIGHT, LINE_SRC_WIDTH, ProbeGeometry,
+};
+use crate::pixel::ProbePixel;
+
+fn check_row_count(rows: usize, width: usize, height: usize) -> Result<(), Error> {
+    if rows != height {
+        return Err(Error::WrongDimensions {
+            expected_w: width,
+            expected_h: height,
+            actual_w: width,
+            actual_h: rows,
+        });
+    }
+    Ok(())
+}
+
+/// Streaming downscale analysis of a resized dot pattern
+/// (`width` x [`DOT_DST_HEIGHT`]).
+#[derive(Debug, Clone)]
+pub struct DotStream<T = u8> {
+    width: usize,
+    srgb: bool,
+    rows: usize,
+    /// Strip-major running sums of normalized weights.
+    sums: Vec<f64>,
+    format: PhantomData<T>,
+}
+
+impl<T: ProbePixel> DotStream<T> {
+    /// Start a stream for a dot pattern resized to `width` columns.
+    pub fn new(width: usize, srgb: bool) -> Self {
+        Self {
+            width,
+            srgb,
+            rows: 0,
+            sums: vec![0.0; DOT_NUM_STRIPS * width],
+            format: PhantomData,
+        }
+    }
+
+    /// Rows pushed so far.
+    pub fn rows(&self) -> usize {
+        self.rows
+    }
+
+    /// Fold the next output row into its strip's sums.
+    ///
+    /// # Panics
+    ///
+    /// If `row` is not `width` long, or all [`DOT_DST_HEIGHT`] rows have
+    /// already been pushed.
+    pub fn push_row(&mut self, row: &[T]) {
+        assert_eq!(row.len(), self.width, "dot row must be {} wide", self.width);
+        assert!(
+            self.rows < DOT_DST_HEIGHT,
+            "dot image has only {DOT_DST_HEIGHT} rows"
+        );
+
+        let decode = T::weight_decoder(self.srgb);
+        let strip = self.rows / DOT_STRIP_HEIGHT;
+        let strip_sums = &mut self.sums[strip * self.width..][..self.width];
+        for (tot, &raw) in strip_sums.iter_mut().zip(row) {
+            *tot += decode(raw);
+        }
+        self.rows += 1;
+    }
+
+    /// Reconstruct the curve. Fails with [`Error::WrongDimensions`] if fewer
+    /// than [`DOT_DST_HEIGHT`] rows were pushed.
+    pub fn finish(self) -> Result<FilterCurve, Error> {
+        check_row_count(self.rows, self.width, DOT_DST_HEIGHT)?;
+        Ok(analyze::dot_curve_from_strip_sums(
+            &ProbeGeometry::DEFAULT,
+            self.width,
+            &self.sums,
+        ))
+    }
+}
+
+/// Streaming upscale analysis of a resized line pattern (`width` x `height`).
+///
+/// Keeps at most three rows around the middle scanline.
+#[derive(Debug, Clone)]
+pub struct LineStream<T = u8> {
+    width: usize,
+    height: usize,
+    srgb: bool,
+    rows: usize,
+    /// The rows `first_kept..first_kept + keep` are the ones the analysis reads.
+    first_kept: usize,
+    keep: usize,
+    kept: Vec<Vec<T>>,
+}
+
+impl<T: ProbePixel> LineStream<T> {
+    /// Start a stream for a line pattern resized to `width` x `height`.
+    pub fn new(width: usize, height: usize, srgb: bool) -> Self {
+        let (first_kept, last_kept) = (0..width.min(3))
+            .map(|i| analyze::line_scanline(i, height))
+            .fold((usize::MAX, 0), |(lo, hi), y| (lo.min(y), hi.max(y)));
+        let keep = if first_kept == usize::MAX {
+            0
+        } else {
+            last_kept - first_kept + 1
+        };
+        Self {
+            width,
+            height,
+            srgb,
+            rows: 0,
+            first_kept,
+            keep,
+            kept: Vec::with_capacity(keep),
+        }
+    }
+
+    /// Rows pushed so far.
+    pub fn rows(&self) -> usize {
+        self.rows
+    }
+
+    /// Accept the next output row, keeping it only if the analysis reads it.
+    ///
+    /// # Panics
+    ///
+    /// If `row` is not `width` long, or `height` rows were already pushed.
+    pub fn push_row(&mut self, row: &[T]) {
+        assert_eq!(
+            row.len(),
+            self.width,
+            "line row must be {} wide",
+            self.width
+        );
+        assert!(
+            self.rows < self.height,
+            "line image has only {} rows",
+            self.height
+        );
+        if self.rows >= self.first_kept && self.kept.len() < self.keep {
+            self.kept.push(row.to_vec());
+        }
+        self.rows += 1;
+    }
+
+    /// Reconstruct the curve. Fails with [`Error::WrongDimensions`] if fewer
+    /// than `height` rows were pushed.
+    pub fn finish(self) -> Result<FilterCurve, Error> {
+        check_row_count(self.rows, self.width, self.height)?;
+        let decode = T::weight_decoder(self.srgb);
+        Ok(analyze::line_curve(
+            LINE_SRC_WIDTH,
+            self.width,
+            self.height,
+            |y, i| decode(self.kept[y - self.first_kept][i]),
+        ))
+    }
+}
+
+/// Streaming edge detection on a resized edge pattern (`width` x `height`).
+///
+/// Keeps only the middle scanline.
+#[derive(Debug, Clone)]
+pub struct EdgeStream<T = u8> {
+    width: usize,
+    height: usize,
+    rows: usize,
+    scanline: Option<Vec<T>>,
+}
+
+impl<T: ProbePixel> EdgeStream<T> {
+    /// Start a stream for an edge pattern resized to `width` x `height`.
+    pub fn new(width: usize, height: usize) -> Self {
+        Self {
+            width,
+            height,
+            rows: 0,
+            scanline: None,
+        }
+    }
+
+    /// Rows pushed so far.
+    pub fn rows(&self) -> usize {
+        self.rows
+    }
+
+    /// Accept the next output row, keeping it only if it is the middle one.
+    ///
+    /// # Panics
+    ///
+    /// If `row` is not `width` long, or `height` rows were already pushed.
+    pub fn push_row(&mut self, row: &[T]) {
+        assert_eq!(
+            row.len(),
+            self.width,
+            "edge row must be {} wide",
+            self.width
+        );
+        assert!(
+            self.rows < self.height,
+            "edge image has only {} rows",
+            self.height
+        );
+        if self.rows == self.height / 2 {
+            self.scanline = Some(row.to_vec());
+        }
+        self.rows += 1;
+    }
+
+    /// Classify the edge handling; [`EdgeMode::Unknown`] if the image was
+    /// incomplete or the wrong size, as with [`edge::detect`].
+    pub fn finish(self) -> EdgeMode {
+        match self.scanline {
+            Some(row) if self.rows == self.height => edge::classify_scanline(&row),
+            _ => EdgeMode::Unknown,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{KnownFilter, pattern, perfect_resize};
+
+    fn assert_same_curve(a: &FilterCurve, b: &FilterCurve) {
+        assert_eq!(a.points, b.points);
+        assert_eq!(a.area, b.area);
+        assert_eq!(a.scale_factor, b.scale_factor);
+        assert_eq!(a.is_scatter, b.is_scatter);
+    }
+
+    #[test]
+    fn dot_stream_matches_analyze_dot() {
+        let (w, h) = analyze::dot_target();
+        for srgb in [false, true] {
+            let img = perfect_resize(pattern::dot_pattern(), w, h, KnownFilter::Mitchell);
+            let mut stream = DotStream::new(w, srgb);
+            for row in img.rows() {
+                stream.push_row(&row[..w]);
+            }
+            let streamed = stream.finish().unwrap();
+            assert_same_curve(&streamed, &analyze::analyze_dot(&img.as_ref(), srgb));
+        }
+    }
+
+    #[test]
+    fn line_and_edge_streams_match_full_image() {
+        let (w, h) = analyze::line_target();
+        let img = perfect_resize(pattern::line_pattern(), w, h, KnownFilter::Lanczos3);
+        let mut line = LineStream::new(w, h, false);
+        for row in img.rows() {
+            line.push_row(&row[..w]);
+        }
+        assert_same_curve(
+            &line.finish().unwrap(),
+            &analyze::analyze_line(&img.as_ref(), false),
+        );
+
+        let img = perfect_resize(pattern::edge_pattern(), w, h, KnownFilter::Lanczos3);
+        let mut edge_stream = EdgeStream::new(w, h);
+        for row in img.rows() {
+            edge_stream.push_row(&row[..w]);
+        }
+        assert_eq!(edge_stream.finish(), edge::classify(img.as_ref()));
+    }
+
+    #[test]
+    fn short_stream_is_an_error() {
+        let mut stream = DotStream::new(4, false);
+        stream.push_row(&[0u8; 4]);
+        assert!(matches!(
+            stream.finish(),
+            Err(Error::WrongDimensions { actual_h: 1, .. })
+        ));
+    }
+}
@@ -0,0 +1,161 @@
+//! Probing one resizer at several scale ratios in a single run.
+//!
+//! [`analyze`](fn@crate::analyze) measures a resizer at the original tool's two
+//! fixed ratios (557->555 and 15->555). Many resizers pick their kernel or its
+//! width from the ratio, so [`analyze_suite`] repeats the dot and line probes
+//! for a list of [`ProbeGeometry`] values instead. The patterns of each
+//! geometry ([`pattern::patterns_for`]) and the offset tables of each output
+//! width ([`analyze::dot_offset_table_for`]) are cached, so re-running a suite
+//! only pays for the resizes and the analysis.
+
+use crate::analyze::{self, FilterCurve};
+use crate::edge::{self, EdgeMode};
+use crate::pattern::{self, ProbeGeometry};
+use crate::score;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFn};
+
+/// The result of one geometry of an [`analyze_suite`] run.
+#[derive(Debug)]
+pub struct SuiteOutcome {
+    /// The geometry that was probed.
+    pub geometry: ProbeGeometry,
+    /// The analysis at that geometry. Its `edge_mode` is shared by every
+    /// outcome of the run, since the edge probe does not depend on the ratio.
+    pub result: Result<AnalysisResult, Error>,
+}
+
+/// Geometries for the horizontal ratios `scales`, via [`ProbeGeometry::at_scale`].
+///
+/// Returns [`Error::InvalidGeometry`] if any ratio is out of range.
+pub fn scale_sweep(scales: &[f64]) -> Result<Vec<ProbeGeometry>, Error> {
+    scales.iter().map(|&s| ProbeGeometry::at_scale(s)).collect()
+}
+
+/// Run the dot and line probes of every geometry in `geometries` against
+/// `resize`, in order, and the edge probe once (if `config.detect_edges`).
+///
+/// Each result is scored on its upscale (line) curve when the line probe
+/// enlarges, as in [`analyze`](fn@crate::analyze), and otherwise on its
+/// downscale (dot) curve: shrunk to a few pixels the line probe has almost no
+/// data, while the dot probe still samples every phase. A failure at one
+/// geometry, including [`Error::InvalidGeometry`] for a geometry that
+/// [`ProbeGeometry::validate`] rejects, does not stop the others.
+pub fn analyze_suite(
+    resize: &ResizeFn,
+    geometries: &[ProbeGeometry],
+    config: &AnalysisConfig,
+) -> Vec<SuiteOutcome> {
+    let edge_mode = config
+        .detect_edges
+        .then(|| edge::detect_with(resize, config.line_probe));
+    geometries
+        .iter()
+        .map(|&geometry| SuiteOutcome {
+            geometry,
+            result: probe_geometry(resize, &geometry, config, edge_mode),
+        })
+        .collect()
+}
+
+fn probe_geometry(
+    resize: &ResizeFn,
+    geometry: &ProbeGeometry,
+    config: &AnalysisConfig,
+    edge_mode: Option<EdgeMode>,
+) -> Result<AnalysisResult, Error> {
+    let patterns = pattern::patterns_for(geometry)?;
+
+    let (dot_w, dot_h) = geometry.dot_target();
+    let dot_resized = resize(patterns.dot.as_ref(), dot_w, dot_h);
+    crate::check_dimensions(&dot_resized, dot_w, dot_h)?;
+    let downscale_curve = analyze::analyze_dot_with(&dot_resized.as_ref(), config.srgb, geometry);
+
+    let (line_w, _) = geometry.line_target();
+    let line_h = config.line_probe.rows();
+    let line_resized = resize(
+        config.line_probe.crop(patterns.line.as_ref()),
+        line_w,
+        line_h,
+    );
+    crate::check_dimensions(&line_resized, line_w, line_h)?;
+    let upscale_curve = analyze::analyze_line_with(&line_resized.as_ref(), config.srgb, geometry);
+
+    let (first, second) = if geometry.line_scale() > 1.0 {
+        (&upscale_curve, &downscale_curve)
+    } else {
+        (&downscale_curve, &upscale_curve)
+    };
+    let scores = score::score_against_all(scoring_curve(first, second)?);
+
+    Ok(AnalysisResult {
+        downscale_curve: Some(downscale_curve),
+        upscale_curve: Some(upscale_curve),
+        scores,
+        edge_mode,
+    })
+}
+
+fn scoring_curve<'a>(
+    first: &'a FilterCurve,
+    second: &'a FilterCurve,
+) -> Result<&'a FilterCurve, Error> {
+    [first, second]
+        .into_iter()
+        .find(|c| !c.points.is_empty())
+        .ok_or(Error::NoData)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::KnownFilter;
+    use crate::test_util::lanczos3;
+
+    #[test]
+    fn default_geometry_matches_analyze() {
+        let config = AnalysisConfig::default();
+        let suite = analyze_suite(&lanczos3, &[ProbeGeometry::DEFAULT], &config);
+        let single = crate::analyze(&lanczos3, &config).unwrap();
+        let result = suite[0].result.as_ref().unwrap();
+        assert_eq!(
+            result.downscale_curve.as_ref().unwrap().points,
+            single.downscale_curve.as_ref().unwrap().points
+        );
+        assert_eq!(result.scores[0].filter, single.scores[0].filter);
+        assert_eq!(result.scores[0].correlation, single.scores[0].correlation);
+        assert_eq!(result.edge_mode, single.edge_mode);
+    }
+
+    #[test]
+    fn sweep_finds_the_filter_at_every_ratio() {
+        let config = AnalysisConfig {
+            detect_edges: false,
+            ..Default::default()
+        };
+        let sweep = scale_sweep(&[0.25, 0.5, 2.0, 3.7]).unwrap();
+        for outcome in analyze_suite(&lanczos3, &sweep, &config) {
+            let result = outcome.result.unwrap();
+            let best = result.best_match().expect("a confident match");
+            assert_eq!(best.filter, KnownFilter::Lanczos3, "{:?}", outcome.geometry);
+            assert!(result.edge_mode.is_none());
+        }
+
+        let g = sweep[0];
+        assert!(std::sync::Arc::ptr_eq(
+            &analyze::dot_offset_table_for(&g, g.dot_dst_width).unwrap(),
+            &analyze::dot_offset_table_for(&g, g.dot_dst_width).unwrap()
+        ));
+    }
+
+    #[test]
+    fn invalid_geometry_fails_only_its_outcome() {
+        let even = ProbeGeometry {
+            dot_span: 24,
+            ..ProbeGeometry::DEFAULT
+        };
+        let config = AnalysisConfig::default();
+        let suite = analyze_suite(&lanczos3, &[even, ProbeGeometry::DEFAULT], &config);
+        assert!(matches!(suite[0].result, Err(Error::InvalidGeometry(_))));
+        assert!(suite[1].result.is_ok());
+    }
+}
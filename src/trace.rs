@@ -0,0 +1,366 @@
+//! Per-stage timing of an analysis run.
+//!
+//! [`analyze_observed`] runs the same steps as [`analyze`](fn@crate::analyze)
+//! and reports each one to an [`Observer`]: when it starts, how long it took,
+//! and, for every resize callback, how many bytes went in and came out. The
+//! [`StageTimings`] observer collects these into a table that separates time
+//! spent in the resizer under test from time spent in the crate.
+//!
+//! [`analyze`](fn@crate::analyze) itself runs through the same driver with an
+//! observer that ignores everything. The observer is a generic parameter, so
+//! the unobserved path compiles down to the plain sequence of probes without
+//! reading the clock.
+
+use std::fmt;
+use std::time::{Duration, Instant};
+
+use imgref::ImgVec;
+
+use crate::analyze;
+use crate::edge::{self, EdgeMode};
+use crate::pixel::ProbePixel;
+use crate::{AnalysisConfig, AnalysisResult, Error, ResizeFnOf};
+
+/// One of the three resize calls of an analysis.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Probe {
+    /// The dot pattern, 557 -> 555.
+    Dot,
+    /// The line pattern, 15 -> 555.
+    Line,
+    /// The edge pattern, 15 -> 555.
+    Edge,
+}
+
+/// A step of an analysis run, as reported to an [`Observer`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Stage {
+    /// Fetching the probe patterns (generated on first use, then cached).
+    Patterns,
+    /// The resize callback, for one probe.
+    Resize(Probe),
+    /// Reconstructing the dot or line curve from the resized image.
+    Analysis(Probe),
+    /// Scoring the curve against the known filters.
+    Scoring,
+    /// Classifying edge handling from the resized edge pattern.
+    EdgeDetection,
+}
+
+impl Stage {
+    /// True for time spent inside the caller's resize callback.
+    pub fn is_callback(self) -> bool {
+        matches!(self, Self::Resize(_))
+    }
+}
+
+impl fmt::Display for Stage {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            Self::Patterns => f.write_str("patterns"),
+            Self::Resize(p) => write!(f, "resize ({p:?})"),
+            Self::Analysis(p) => write!(f, "analysis ({p:?})"),
+            Self::Scoring => f.write_str("scoring"),
+            Self::EdgeDetection => f.write_str("edge detection"),
+        }
+    }
+}
+
+/// Receives the events of [`analyze_observed`]. Every method has an empty
+/// default, so implement only the ones you need.
+pub trait Observer {
+    /// `stage` is about to run.
+    fn stage_start(&mut self, stage: Stage) {
+        let _ = stage;
+    }
+
+    /// `stage` finished after `elapsed`.
+    fn stage_end(&mut self, stage: Stage, elapsed: Duration) {
+        let _ = (stage, elapsed);
+    }
+
+    /// The resize callback for `probe` was given `input` bytes of pixels and
+    /// returned `output` bytes.
+    fn callback_bytes(&mut self, probe: Probe, input: usize, output: usize) {
+        let _ = (probe, input, output);
+    }
+
+    /// Whether stages should be timed. If false, the clock is never read and
+    /// [`stage_end`](Self::stage_end) is given [`Duration::ZERO`].
+    fn wants_timings(&self) -> bool {
+        true
+    }
+}
+
+/// The observer [`analyze`](fn@crate::analyze) runs with: ignores every event
+/// and turns timing off.
+pub(crate) struct NoObserver;
+
+impl Observer for NoObserver {
+    fn wants_timings(&self) -> bool {
+        false
+    }
+}
+
+/// An [`Observer`] that records every stage with its duration, in order.
+#[derive(Debug, Clone, Default)]
+pub struct StageTimings {
+    /// Completed stages and how long each took.
+    pub stages: Vec<(Stage, Duration)>,
+    /// `(probe, input bytes, output bytes)` of every resize callback.
+    pub bytes: Vec<(Probe, usize, usize)>,
+}
+
+impl StageTimings {
+    /// An empty collector.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Total time inside the resize callback.
+    pub fn callback_time(&self) -> Duration {
+        self.sum(|s| s.is_callback())
+    }
+
+    /// Total time in the crate's own stages.
+    pub fn crate_time(&self) -> Duration {
+        self.sum(|s| !s.is_callback())
+    }
+
+    /// Total time of all recorded stages.
+    pub fn total(&self) -> Duration {
+        self.sum(|_| true)
+    }
+
+    /// Bytes passed to and returned from the callback, summed over all probes.
+    pub fn callback_bytes(&self) -> (usize, usize) {
+        self.bytes
+            .iter()
+            .fold((0, 0), |(i, o), &(_, bi, bo)| (i + bi, o + bo))
+    }
+
+    fn sum(&self, keep: impl Fn(Stage) -> bool) -> Duration {
+        self.stages
+            .iter()
+            .filter(|(s, _)| keep(*s))
+            .map(|&(_, d)| d)
+            .sum()
+    }
+}
+
+impl Observer for StageTimings {
+    fn stage_end(&mut self, stage: Stage, elapsed: Duration) {
+        self.stages.push((stage, elapsed));
+    }
+
+    fn callback_bytes(&mut self, probe: Probe, input: usize, output: usize) {
+        self.bytes.push((probe, input, output));
+    }
+}
+
+impl fmt::Display for StageTimings {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        for (stage, elapsed) in &self.stages {
+            writeln!(f, "  {:<20} {:>10.3} ms", stage.to_string(), ms(*elapsed))?;
+        }
+        let (input, output) = self.callback_bytes();
+        write!(
+            f,
+            "  callback {:.3} ms, crate {:.3} ms; {input} bytes in, {output} bytes out",
+            ms(self.callback_time()),
+            ms(self.crate_time())
+        )
+    }
+}
+
+fn ms(d: Duration) -> f64 {
+    d.as_secs_f64() * 1e3
+}
+
+fn timed<O: Observer + ?Sized, R>(observer: &mut O, stage: Stage, f: impl FnOnce() -> R) -> R {
+    observer.stage_start(stage);
+    let start = observer.wants_timings().then(Instant::now);
+    let out = f();
+    observer.stage_end(stage, start.map_or(Duration::ZERO, |s| s.elapsed()));
+    out
+}
+
+fn bytes<T>(pixels: usize) -> usize {
+    pixels * std::mem::size_of::<T>()
+}
+
+/// Run the resize callback for `probe`, reporting its time and byte counts.
+fn observed_resize<T: ProbePixel, O: Observer + ?Sized>(
+    resize: &ResizeFnOf<T>,
+    observer: &mut O,
+    probe: Probe,
+    src: imgref::ImgRef<'_, T>,
+    (w, h): (usize, usize),
+) -> ImgVec<T> {
+    let out = timed(observer, Stage::Resize(probe), || resize(src, w, h));
+    observer.callback_bytes(
+        probe,
+        bytes::<T>(src.width() * src.height()),
+        bytes::<T>(out.width() * out.height()),
+    );
+    out
+}
+
+/// [`analyze`](fn@crate::analyze), reporting every stage to `observer`.
+///
+/// The result is the same as `analyze` returns; the observer only watches.
+/// `observer` may be a concrete type or a `dyn Observer`.
+pub fn analyze_observed<O: Observer + ?Sized>(
+    resize: &crate::ResizeFn,
+    config: &AnalysisConfig,
+    observer: &mut O,
+) -> Result<AnalysisResult, Error> {
+    analyze_observed_as::<u8, O>(resize, config, observer)
+}
+
+/// [`analyze_observed`] for a resizer in any [`ProbePixel`] format. This is
+/// the driver behind [`analyze_as`](crate::analyze_as) as well.
+pub fn analyze_observed_as<T: ProbePixel, O: Observer + ?Sized>(
+    resize: &ResizeFnOf<T>,
+    config: &AnalysisConfig,
+    observer: &mut O,
+) -> Result<AnalysisResult, Error> {
+    let patterns = timed(observer, Stage::Patterns, T::patterns);
+
+    let dot_target = analyze::dot_target();
+    let dot = observed_resize(
+        resize,
+        observer,
+        Probe::Dot,
+        patterns.dot.as_ref(),
+        dot_target,
+    );
+    crate::check_dimensions(&dot, dot_target.0, dot_target.1)?;
+    let downscale_curve = timed(observer, Stage::Analysis(Probe::Dot), || {
+        analyze::analyze_dot(&dot.as_ref(), config.srgb)
+    });
+    drop(dot);
+
+    let line_target = config.line_probe.target();
+    let line_src = config.line_probe.crop(patterns.line.as_ref());
+    let line = observed_resize(resize, observer, Probe::Line, line_src, line_target);
+    crate::check_dimensions(&line, line_target.0, line_target.1)?;
+    let upscale_curve = timed(observer, Stage::Analysis(Probe::Line), || {
+        analyze::analyze_line(&line.as_ref(), config.srgb)
+    });
+
+    let edge_mode = config.detect_edges.then(|| {
+        let edge_src = config.line_probe.crop(patterns.edge.as_ref());
+        let resized = observed_resize(resize, observer, Probe::Edge, edge_src, line_target);
+        timed(observer, Stage::EdgeDetection, || {
+            if (resized.width(), resized.height()) == line_target {
+                edge::classify(resized.as_ref())
+            } else {
+                EdgeMode::Unknown
+            }
+        })
+    });
+
+    timed(observer, Stage::Scoring, || {
+        crate::assemble_result(downscale_curve, upscale_curve, edge_mode)
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::test_util::lanczos3;
+    use imgref::ImgRef;
+
+    fn slow(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+        std::thread::sleep(Duration::from_millis(20));
+        lanczos3(src, w, h)
+    }
+
+    #[test]
+    fn reports_every_stage_in_order() {
+        let config = AnalysisConfig::default();
+        let mut timings = StageTimings::new();
+        let observed = analyze_observed(&lanczos3, &config, &mut timings).unwrap();
+        let plain = crate::analyze(&lanczos3, &config).unwrap();
+        assert_eq!(observed.scores[0].filter, plain.scores[0].filter);
+        assert_eq!(observed.scores[0].correlation, plain.scores[0].correlation);
+        assert_eq!(observed.edge_mode, plain.edge_mode);
+
+        let stages: Vec<Stage> = timings.stages.iter().map(|&(s, _)| s).collect();
+        assert_eq!(
+            stages,
+            [
+                Stage::Patterns,
+                Stage::Resize(Probe::Dot),
+                Stage::Analysis(Probe::Dot),
+                Stage::Resize(Probe::Line),
+                Stage::Analysis(Probe::Line),
+                Stage::Resize(Probe::Edge),
+                Stage::EdgeDetection,
+                Stage::Scoring,
+            ]
+        );
+        assert_eq!(
+            timings.bytes,
+            [
+                (Probe::Dot, 557 * 275, 555 * 275),
+                (Probe::Line, 15 * 15, 555 * 15),
+                (Probe::Edge, 15 * 15, 555 * 15),
+            ]
+        );
+        assert!(timings.to_string().contains("edge detection"));
+
+        let dynamic: &mut dyn Observer = &mut StageTimings::new();
+        analyze_observed(&lanczos3, &config, dynamic).unwrap();
+    }
+
+    #[test]
+    fn no_observer_skips_the_clock() {
+        struct Durations(Vec<Duration>, bool);
+        impl Observer for Durations {
+            fn stage_end(&mut self, _: Stage, elapsed: Duration) {
+                self.0.push(elapsed);
+            }
+            fn wants_timings(&self) -> bool {
+                self.1
+            }
+        }
+        let mut untimed = Durations(Vec::new(), false);
+        analyze_observed(&slow, &AnalysisConfig::default(), &mut untimed).unwrap();
+        assert_eq!(untimed.0.len(), 8);
+        assert!(untimed.0.iter().all(|d| d.is_zero()));
+    }
+
+    #[test]
+    fn separates_callback_time() {
+        struct Events(Vec<(bool, Stage)>);
+        impl Observer for Events {
+            fn stage_start(&mut self, stage: Stage) {
+                self.0.push((true, stage));
+            }
+            fn stage_end(&mut self, stage: Stage, _: Duration) {
+                self.0.push((false, stage));
+            }
+        }
+
+        let config = AnalysisConfig {
+            detect_edges: false,
+            ..Default::default()
+        };
+        let mut timings = StageTimings::new();
+        analyze_observed(&slow, &config, &mut timings).unwrap();
+        assert!(timings.callback_time() >= Duration::from_millis(40));
+        assert_eq!(
+            timings.total(),
+            timings.callback_time() + timings.crate_time()
+        );
+
+        let mut events = Events(Vec::new());
+        analyze_observed(&lanczos3, &config, &mut events).unwrap();
+        // Stages do not nest: every start is followed by its own end.
+        for pair in events.0.chunks(2) {
+            assert_eq!(pair, [(true, pair[0].1), (false, pair[0].1)]);
+        }
+    }
+}
@@ -32,6 +32,28 @@ unsafe extern "C" {
         out_area: *mut f64,
     ) -> f64;
 
+    fn rs_analyze_dot_batch(
+        images: *const u8,
+        n: i32,
+        w: i32,
+        h: i32,
+        srgb: i32,
+        offsets: *mut f64,
+        weights: *mut f64,
+        out_counts: *mut i32,
+    ) -> f64;
+
+    fn rs_analyze_line_batch(
+        images: *const u8,
+        n: i32,
+        w: i32,
+        h: i32,
+        srgb: i32,
+        offsets: *mut f64,
+        weights: *mut f64,
+        out_areas: *mut f64,
+    ) -> f64;
+
     fn rs_dot_src_width() -> i32;
     fn rs_dot_src_height() -> i32;
     fn rs_dot_dst_width() -> i32;
@@ -138,10 +160,7 @@ fn dot_analysis_matches_c() {
     let resized = nn_resize(dot.as_ref(), 555, 275);
 
     // Run Rust analysis.
-    let config = resamplescope::AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = resamplescope::AnalysisConfig::default().with_detect_edges(false);
     let rust_result = resamplescope::analyze_downscale(&nn_resize, &config).unwrap();
     let rust_curve = rust_result.downscale_curve.as_ref().unwrap();
 
@@ -216,10 +235,7 @@ fn line_analysis_matches_c() {
     let resized = nn_resize(line.as_ref(), 555, 15);
 
     // Run Rust analysis.
-    let config = resamplescope::AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = resamplescope::AnalysisConfig::default().with_detect_edges(false);
     let rust_result = resamplescope::analyze_upscale(&nn_resize, &config).unwrap();
     let rust_curve = rust_result.upscale_curve.as_ref().unwrap();
 
@@ -300,10 +316,9 @@ fn line_analysis_with_srgb_matches_c() {
     let resized = resamplescope::perfect_resize(line.as_ref(), 555, 15, KnownFilter::Lanczos3);
 
     // Rust analysis with sRGB.
-    let config = resamplescope::AnalysisConfig {
-        srgb: true,
-        detect_edges: false,
-    };
+    let config = resamplescope::AnalysisConfig::default()
+        .with_srgb(true)
+        .with_detect_edges(false);
     let resize_fn = |src: ImgRef<'_, u8>, w: usize, h: usize| -> ImgVec<u8> {
         resamplescope::perfect_resize(src, w, h, KnownFilter::Lanczos3)
     };
@@ -369,10 +384,7 @@ fn dot_analysis_perfect_resize_matches_c() {
     let resize_fn = |src: ImgRef<'_, u8>, w: usize, h: usize| -> ImgVec<u8> {
         resamplescope::perfect_resize(src, w, h, KnownFilter::Lanczos3)
     };
-    let config = resamplescope::AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = resamplescope::AnalysisConfig::default().with_detect_edges(false);
     let rust_result = resamplescope::analyze_downscale(&resize_fn, &config).unwrap();
     let rust_curve = rust_result.downscale_curve.as_ref().unwrap();
 
@@ -418,3 +430,90 @@ fn dot_analysis_perfect_resize_matches_c() {
         "Lanczos3 dot analysis: {c_count} points, max weight err={max_weight_err:.2e}"
     );
 }
+
+#[test]
+fn batch_analysis_matches_rust_for_every_filter() {
+    let filters = KnownFilter::all_named();
+    let n = filters.len();
+    let dots: Vec<u8> = filters
+        .iter()
+        .flat_map(|&f| {
+            resamplescope::perfect_resize(resamplescope::pattern::dot_pattern(), 555, 275, f)
+                .into_buf()
+        })
+        .collect();
+    let lines: Vec<u8> = filters
+        .iter()
+        .flat_map(|&f| {
+            resamplescope::perfect_resize(resamplescope::pattern::line_pattern(), 555, 15, f)
+                .into_buf()
+        })
+        .collect();
+
+    let dot_stride = 555 * 25;
+    let mut max_err = 0.0f64;
+    for srgb in [false, true] {
+        // One call per probe for every filter.
+        let mut dot_offsets = vec![0.0f64; n * dot_stride];
+        let mut dot_weights = vec![0.0f64; n * dot_stride];
+        let mut dot_counts = vec![0i32; n];
+        let mut line_offsets = vec![0.0f64; n * 555];
+        let mut line_weights = vec![0.0f64; n * 555];
+        let mut line_areas = vec![0.0f64; n];
+        unsafe {
+            rs_analyze_dot_batch(
+                dots.as_ptr(),
+                n as i32,
+                555,
+                275,
+                srgb as i32,
+                dot_offsets.as_mut_ptr(),
+                dot_weights.as_mut_ptr(),
+                dot_counts.as_mut_ptr(),
+            );
+            rs_analyze_line_batch(
+                lines.as_ptr(),
+                n as i32,
+                555,
+                15,
+                srgb as i32,
+                line_offsets.as_mut_ptr(),
+                line_weights.as_mut_ptr(),
+                line_areas.as_mut_ptr(),
+            );
+        }
+
+        for (i, filter) in filters.iter().enumerate() {
+            let dot = ImgRef::new(&dots[i * 555 * 275..][..555 * 275], 555, 275);
+            let rust_dot = resamplescope::analyze::analyze_dot(&dot, srgb);
+            assert_eq!(
+                rust_dot.points.len(),
+                dot_counts[i] as usize,
+                "{filter} srgb={srgb}"
+            );
+            for (j, &(off, wt)) in rust_dot.points.iter().enumerate() {
+                assert_eq!(
+                    off,
+                    dot_offsets[i * dot_stride + j],
+                    "{filter} srgb={srgb} dot {j}"
+                );
+                max_err = max_err.max((wt - dot_weights[i * dot_stride + j]).abs());
+            }
+
+            let line = ImgRef::new(&lines[i * 555 * 15..][..555 * 15], 555, 15);
+            let rust_line = resamplescope::analyze::analyze_line(&line, srgb);
+            max_err = max_err.max((rust_line.area - line_areas[i]).abs());
+            for (j, &(off, wt)) in rust_line.points.iter().enumerate() {
+                assert_eq!(
+                    off,
+                    line_offsets[i * 555 + j],
+                    "{filter} srgb={srgb} line {j}"
+                );
+                max_err = max_err.max((wt - line_weights[i * 555 + j]).abs());
+            }
+        }
+    }
+
+    assert!(max_err < 1e-10, "max err={max_err:.2e}");
+    println!("batch analysis: {n} filters x 2 modes, max err={max_err:.2e}");
+}
@@ -1,5 +1,7 @@
+use std::sync::atomic::{AtomicUsize, Ordering};
+
 use imgref::{ImgRef, ImgVec};
-use resamplescope::{AnalysisConfig, KnownFilter};
+use resamplescope::{AnalysisConfig, KnownFilter, LineProbe};
 
 /// Simple box (nearest-neighbor) resize for testing.
 fn nn_resize(src: ImgRef<'_, u8>, dst_w: usize, dst_h: usize) -> ImgVec<u8> {
@@ -54,10 +56,7 @@ fn bilinear_resize(src: ImgRef<'_, u8>, dst_w: usize, dst_h: usize) -> ImgVec<u8
 
 #[test]
 fn box_filter_detection() {
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze(&nn_resize, &config).unwrap();
 
     assert!(result.downscale_curve.is_some());
@@ -75,10 +74,7 @@ fn box_filter_detection() {
 
 #[test]
 fn triangle_filter_detection() {
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze(&bilinear_resize, &config).unwrap();
 
     let best = &result.scores[0];
@@ -102,10 +98,7 @@ fn perfect_resize_detected_correctly() {
         resamplescope::perfect_resize(src, w, h, KnownFilter::Lanczos3)
     };
 
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze(&resize_fn, &config).unwrap();
 
     let best = &result.scores[0];
@@ -142,10 +135,7 @@ fn ssim_perfect_vs_nn() {
 
 #[test]
 fn graph_rendering() {
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze(&nn_resize, &config).unwrap();
 
     let graph = result.render_graph();
@@ -181,10 +171,7 @@ fn weight_table_correctness() {
 
 #[test]
 fn upscale_only_analysis() {
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze_upscale(&bilinear_resize, &config).unwrap();
 
     assert!(result.downscale_curve.is_none());
@@ -196,12 +183,107 @@ fn upscale_only_analysis() {
 
 #[test]
 fn downscale_only_analysis() {
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
     let result = resamplescope::analyze_downscale(&nn_resize, &config).unwrap();
 
     assert!(result.downscale_curve.is_some());
     assert!(result.upscale_curve.is_none());
 }
+
+/// Separable Lanczos3 resize in f64, with no clamping or rounding, for probing
+/// the wide sample formats.
+fn lanczos3_float(src: &[f64], sw: usize, sh: usize, dw: usize, dh: usize) -> Vec<f64> {
+    let h_table = resamplescope::compute_weight_table(KnownFilter::Lanczos3, sw, dw);
+    let v_table = resamplescope::compute_weight_table(KnownFilter::Lanczos3, sh, dh);
+    let mut tmp = vec![0.0; dw * sh];
+    for y in 0..sh {
+        for x in 0..dw {
+            let (pixels, weights) = h_table.pixel(x);
+            tmp[y * dw + x] = pixels
+                .iter()
+                .zip(weights)
+                .map(|(&p, &w)| src[y * sw + p] * w)
+                .sum();
+        }
+    }
+    let mut dst = vec![0.0; dw * dh];
+    for y in 0..dh {
+        let (rows, weights) = v_table.pixel(y);
+        for x in 0..dw {
+            dst[y * dw + x] = rows
+                .iter()
+                .zip(weights)
+                .map(|(&r, &w)| tmp[r * dw + x] * w)
+                .sum();
+        }
+    }
+    dst
+}
+
+#[test]
+fn wide_formats_detect_lanczos3() {
+    let config = AnalysisConfig::default();
+
+    let f32_resize = |src: ImgRef<'_, f32>, w: usize, h: usize| -> ImgVec<f32> {
+        let buf: Vec<f64> = src.rows().flatten().map(|&v| f64::from(v)).collect();
+        let out = lanczos3_float(&buf, src.width(), src.height(), w, h);
+        ImgVec::new(out.into_iter().map(|v| v as f32).collect(), w, h)
+    };
+    let u16_resize = |src: ImgRef<'_, u16>, w: usize, h: usize| -> ImgVec<u16> {
+        let buf: Vec<f64> = src.rows().flatten().map(|&v| f64::from(v)).collect();
+        let out = lanczos3_float(&buf, src.width(), src.height(), w, h);
+        let out = out
+            .into_iter()
+            .map(|v| v.round().clamp(0.0, 65535.0) as u16);
+        ImgVec::new(out.collect(), w, h)
+    };
+    let u8_resize = |src: ImgRef<'_, u8>, w: usize, h: usize| -> ImgVec<u8> {
+        resamplescope::perfect_resize(src, w, h, KnownFilter::Lanczos3)
+    };
+
+    let narrow = resamplescope::analyze(&u8_resize, &config).unwrap();
+    let float = resamplescope::analyze_f32(&f32_resize, &config).unwrap();
+    let wide = resamplescope::analyze_u16(&u16_resize, &config).unwrap();
+
+    for result in [&float, &wide] {
+        let best = &result.scores[0];
+        assert_eq!(best.filter, KnownFilter::Lanczos3, "got {best}");
+        // No 8-bit quantization, so the fit is at least as tight.
+        assert!(
+            best.rms_error <= narrow.scores[0].rms_error,
+            "{} > {}",
+            best.rms_error,
+            narrow.scores[0].rms_error
+        );
+        assert_eq!(result.edge_mode, narrow.edge_mode);
+    }
+}
+
+static TALLEST_REQUEST: AtomicUsize = AtomicUsize::new(0);
+
+/// CatmullRom reference resize that records the tallest target it was asked for.
+fn counting_catmull_rom(src: ImgRef<'_, u8>, w: usize, h: usize) -> ImgVec<u8> {
+    assert_eq!(src.height(), h);
+    TALLEST_REQUEST.fetch_max(h, Ordering::Relaxed);
+    resamplescope::perfect_resize(src, w, h, KnownFilter::CatmullRom)
+}
+
+#[test]
+fn short_line_probes_match_full() {
+    let full =
+        resamplescope::analyze_upscale(&counting_catmull_rom, &AnalysisConfig::default()).unwrap();
+
+    for (probe, rows) in [(LineProbe::Minimal, 3), (LineProbe::SingleRow, 1)] {
+        TALLEST_REQUEST.store(0, Ordering::Relaxed);
+        let config = AnalysisConfig::default().with_line_probe(probe);
+        let short = resamplescope::analyze_upscale(&counting_catmull_rom, &config).unwrap();
+
+        assert_eq!(TALLEST_REQUEST.load(Ordering::Relaxed), rows, "{probe:?}");
+        assert_eq!(
+            short.upscale_curve.as_ref().unwrap().points,
+            full.upscale_curve.as_ref().unwrap().points,
+            "{probe:?}"
+        );
+        assert_eq!(short.edge_mode, full.edge_mode, "{probe:?}");
+    }
+}
@@ -140,10 +140,9 @@ fn linear_srgb_bilinear_identified_as_triangle() {
 
     // With srgb=true, resamplescope should correct for the nonlinear transfer
     // and correctly identify the underlying triangle filter.
-    let config_srgb = AnalysisConfig {
-        srgb: true,
-        detect_edges: false,
-    };
+    let config_srgb = AnalysisConfig::default()
+        .with_srgb(true)
+        .with_detect_edges(false);
     let result_srgb = resamplescope::analyze(&srgb_bilinear, &config_srgb).unwrap();
 
     let best = &result_srgb.scores[0];
@@ -169,10 +168,7 @@ fn linear_srgb_bilinear_identified_as_triangle() {
 
     // Without srgb correction, the distorted shape should still be *somewhat*
     // identifiable but with lower correlation.
-    let config_linear = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config_linear = AnalysisConfig::default().with_detect_edges(false);
     let result_linear = resamplescope::analyze(&srgb_bilinear, &config_linear).unwrap();
     let best_uncorrected = &result_linear.scores[0];
     println!(
@@ -198,10 +194,9 @@ fn linear_srgb_lanczos3_identification() {
         resamplescope::perfect_resize(src, w, h, KnownFilter::Lanczos3)
     });
 
-    let config = AnalysisConfig {
-        srgb: true,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default()
+        .with_srgb(true)
+        .with_detect_edges(false);
     let result = resamplescope::analyze(&srgb_lanczos, &config).unwrap();
 
     let best = &result.scores[0];
@@ -234,10 +229,9 @@ fn linear_srgb_all_filters_survey() {
     let out = output_dir().join("linear_srgb");
     fs::create_dir_all(&out).unwrap();
 
-    let config = AnalysisConfig {
-        srgb: true,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default()
+        .with_srgb(true)
+        .with_detect_edges(false);
 
     let filters = [
         ("box", KnownFilter::Box),
@@ -94,10 +94,7 @@ fn zenimage_filter_identification_linear() {
     let out = output_dir().join("zenimage");
     fs::create_dir_all(&out).unwrap();
 
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
 
     println!("\n=== Zenimage filter identification (linear_rgb=false) ===\n");
     println!(
@@ -157,10 +154,9 @@ fn zenimage_filter_identification_srgb() {
     let out = output_dir().join("zenimage");
     fs::create_dir_all(&out).unwrap();
 
-    let config = AnalysisConfig {
-        srgb: true,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default()
+        .with_srgb(true)
+        .with_detect_edges(false);
 
     println!("\n=== Zenimage filter identification (linear_rgb=true, srgb correction) ===\n");
     println!(
@@ -232,10 +228,7 @@ fn zenimage_all_filters_survey() {
     let out = output_dir().join("zenimage");
     fs::create_dir_all(&out).unwrap();
 
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
 
     // Filters from downscaling-eval (the 20 tested by imageflow)
     let downscaling_eval_filters = [
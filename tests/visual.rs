@@ -64,10 +64,7 @@ fn write_visual_output() {
     let out = output_dir();
     fs::create_dir_all(&out).unwrap();
 
-    let config = AnalysisConfig {
-        srgb: false,
-        detect_edges: false,
-    };
+    let config = AnalysisConfig::default().with_detect_edges(false);
 
     // Write test patterns.
     write_gray_png(&out.join("dot_pattern.png"), &resamplescope::generate_dot_pattern());